@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CorridorRouter.h"
+#include "Algo/Reverse.h"
+
+namespace
+{
+	struct FOpenNodePredicate
+	{
+		template <typename NodeType>
+		FORCEINLINE bool operator()(const NodeType& A, const NodeType& B) const
+		{
+			return A.EstimatedCost < B.EstimatedCost;
+		}
+	};
+
+	/** Manhattan distance from Cell to the ring of tiles around Room */
+	FORCEINLINE int32 GetDistanceToRoom(const FIntPoint& Cell, const FIntRect& Room)
+	{
+		int32 DistanceX = FMath::Max3(0, (Room.Min.X - 1) - Cell.X, Cell.X - Room.Max.X);
+		int32 DistanceY = FMath::Max3(0, (Room.Min.Y - 1) - Cell.Y, Cell.Y - Room.Max.Y);
+		return DistanceX + DistanceY;
+	}
+}
+
+bool FCorridorRouter::IsNextToRoom(const FIntPoint& Cell, const FIntRect& Room)
+{
+	bool InsideOnX = Cell.X >= Room.Min.X && Cell.X < Room.Max.X;
+	bool InsideOnY = Cell.Y >= Room.Min.Y && Cell.Y < Room.Max.Y;
+
+	return (InsideOnX && (Cell.Y == Room.Min.Y - 1 || Cell.Y == Room.Max.Y))
+		|| (InsideOnY && (Cell.X == Room.Min.X - 1 || Cell.X == Room.Max.X));
+}
+
+void FCorridorRouter::PushNode(const FDungeonTileGrid& Grid, const FIntPoint& Cell, int32 ParentIndex, int32 CostSoFar, const FIntRect& Goal)
+{
+	int32 Index = Grid.ToIndex(Cell);
+
+	if (SearchIds[Index] == CurrentSearchId && CostsSoFar[Index] <= CostSoFar)
+	{
+		return;
+	}
+
+	SearchIds[Index] = CurrentSearchId;
+	CostsSoFar[Index] = CostSoFar;
+	CameFrom[Index] = ParentIndex;
+
+	// The heuristic uses the empty tile cost so the search heads straight for the goal,
+	// this can overestimate when reusing corridors but keeps each search small
+	FOpenNode Node;
+	Node.Index = Index;
+	Node.CostSoFar = CostSoFar;
+	Node.EstimatedCost = CostSoFar + GetDistanceToRoom(Cell, Goal) * EmptyTileCost;
+	OpenList.HeapPush(Node, FOpenNodePredicate());
+}
+
+bool FCorridorRouter::FindPath(const FDungeonTileGrid& Grid, const FIntRect& RoomA, const FIntRect& RoomB, TArray<FIntPoint>& OutPath)
+{
+	OutPath.Reset();
+
+	// Resize the scratch buffers if the grid has changed size since the last search
+	if (SearchIds.Num() != Grid.Num())
+	{
+		CostsSoFar.SetNumUninitialized(Grid.Num());
+		CameFrom.SetNumUninitialized(Grid.Num());
+		SearchIds.Reset();
+		SearchIds.SetNumZeroed(Grid.Num());
+		CurrentSearchId = 0;
+	}
+
+	// Only clear the search ids when the counter wraps around
+	if (++CurrentSearchId == 0)
+	{
+		FMemory::Memzero(SearchIds.GetData(), SearchIds.Num() * sizeof(uint32));
+		CurrentSearchId = 1;
+	}
+
+	OpenList.Reset();
+
+	auto IsWalkable = [&Grid](const FIntPoint& Cell)
+	{
+		return Grid.IsInside(Cell) && Grid.GetTile(Cell).Type != EDungeonTileType::Room;
+	};
+
+	auto GetStepCost = [&Grid](const FIntPoint& Cell)
+	{
+		return Grid.GetTile(Cell).Type == EDungeonTileType::Corridor ? CorridorTileCost : EmptyTileCost;
+	};
+
+	// Seed the search with every free tile along the sides of RoomA
+	for (int32 x = RoomA.Min.X; x < RoomA.Max.X; x++)
+	{
+		for (int32 y : { RoomA.Min.Y - 1, RoomA.Max.Y })
+		{
+			FIntPoint Cell(x, y);
+			if (IsWalkable(Cell))
+			{
+				PushNode(Grid, Cell, INDEX_NONE, GetStepCost(Cell), RoomB);
+			}
+		}
+	}
+
+	for (int32 y = RoomA.Min.Y; y < RoomA.Max.Y; y++)
+	{
+		for (int32 x : { RoomA.Min.X - 1, RoomA.Max.X })
+		{
+			FIntPoint Cell(x, y);
+			if (IsWalkable(Cell))
+			{
+				PushNode(Grid, Cell, INDEX_NONE, GetStepCost(Cell), RoomB);
+			}
+		}
+	}
+
+	while (OpenList.Num() > 0)
+	{
+		FOpenNode Current;
+		OpenList.HeapPop(Current, FOpenNodePredicate(), false);
+
+		// Skip entries that were superseded by a cheaper route after being pushed
+		if (Current.CostSoFar != CostsSoFar[Current.Index])
+		{
+			continue;
+		}
+
+		FIntPoint CurrentCell = Grid.ToCell(Current.Index);
+
+		if (IsNextToRoom(CurrentCell, RoomB))
+		{
+			// Walk back through the search to build the path from RoomA to RoomB
+			for (int32 Index = Current.Index; Index != INDEX_NONE; Index = CameFrom[Index])
+			{
+				OutPath.Add(Grid.ToCell(Index));
+			}
+
+			Algo::Reverse(OutPath);
+			return true;
+		}
+
+		FIntPoint Direction = FIntPoint::ZeroValue;
+		if (CameFrom[Current.Index] != INDEX_NONE)
+		{
+			Direction = CurrentCell - Grid.ToCell(CameFrom[Current.Index]);
+		}
+
+		for (uint8 Side = 0; Side < 4; Side++)
+		{
+			FIntPoint Neighbour = FDungeonTileGrid::GetNeighbour(CurrentCell, static_cast<EDungeonDirection>(Side));
+
+			if (!IsWalkable(Neighbour))
+			{
+				continue;
+			}
+
+			int32 StepCost = GetStepCost(Neighbour);
+			if (Direction != FIntPoint::ZeroValue && Neighbour - CurrentCell != Direction)
+			{
+				StepCost += TurnCost;
+			}
+
+			PushNode(Grid, Neighbour, Current.Index, Current.CostSoFar + StepCost, RoomB);
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonTileGrid.h"
+
+/**
+ * A* search over the FDungeonTileGrid used to route corridors with bends between rooms.
+ * The scratch buffers are kept between searches so routing thousands of corridors doesn't reallocate.
+ */
+class DUNGEON_CPP_API FCorridorRouter
+{
+public:
+
+	/** The cost of stepping onto an empty tile */
+	static constexpr int32 EmptyTileCost = 10;
+
+	/** The cost of stepping onto a tile that is already a corridor, cheaper so corridors merge rather than run side by side */
+	static constexpr int32 CorridorTileCost = 6;
+
+	/** The extra cost of changing direction, keeps corridors straight where possible */
+	static constexpr int32 TurnCost = 4;
+
+	/**
+	 * Finds the cheapest path of tiles from a tile next to RoomA to a tile next to RoomB without passing through any room.
+	 * Rooms are given as tile rectangles with an exclusive Max. Returns false if the rooms can't be connected.
+	 */
+	bool FindPath(const FDungeonTileGrid& Grid, const FIntRect& RoomA, const FIntRect& RoomB, TArray<FIntPoint>& OutPath);
+
+	/** Returns true if Cell is directly next to one of the sides of Room, corners don't count as they can't hold a door */
+	static bool IsNextToRoom(const FIntPoint& Cell, const FIntRect& Room);
+
+private:
+
+	struct FOpenNode
+	{
+		int32 Index;
+		int32 CostSoFar;
+		int32 EstimatedCost;
+	};
+
+	/** Adds Cell to the open list if it's cheaper than any route to it found so far */
+	void PushNode(const FDungeonTileGrid& Grid, const FIntPoint& Cell, int32 ParentIndex, int32 CostSoFar, const FIntRect& Goal);
+
+	/** The cost to reach each tile in the current search */
+	TArray<int32> CostsSoFar;
+
+	/** The tile each tile was reached from in the current search */
+	TArray<int32> CameFrom;
+
+	/** The search that last touched each tile, avoids clearing the buffers between searches */
+	TArray<uint32> SearchIds;
+
+	/** Binary heap of tiles still to be expanded */
+	TArray<FOpenNode> OpenList;
+
+	uint32 CurrentSearchId = 0;
+};
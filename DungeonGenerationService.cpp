@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonGenerationService.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDungeonGenerationService, Log, All);
+
+/** Generates a batch of layouts with the default settings and logs the throughput */
+static FAutoConsoleCommand BenchmarkLayoutsCommand(
+	TEXT("Dungeon.BenchmarkLayouts"),
+	TEXT("Generates a batch of dungeon layouts across the worker threads and logs the dungeons per second per core. Usage: Dungeon.BenchmarkLayouts [NumLayouts]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		int32 NumLayouts = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+
+		TArray<FDungeonLayoutSettings> Jobs;
+		Jobs.SetNum(FMath::Max(NumLayouts, 1));
+
+		for (int32 Index = 0; Index < Jobs.Num(); Index++)
+		{
+			Jobs[Index].Seed = Index + 1;
+		}
+
+		TArray<FDungeonLayoutPtr> Layouts;
+		FDungeonGenerationService::Get().GenerateBatch(Jobs, Layouts);
+	}));
+
+FDungeonGenerationService& FDungeonGenerationService::Get()
+{
+	static TSharedRef<FDungeonGenerationService, ESPMode::ThreadSafe> Service = MakeShared<FDungeonGenerationService, ESPMode::ThreadSafe>();
+	return Service.Get();
+}
+
+void FDungeonGenerationService::Submit(const FDungeonLayoutSettings& Settings, TFunction<void(FDungeonLayoutRef)> OnComplete)
+{
+	check(IsInGameThread());
+
+	if (NumInFlight++ == 0)
+	{
+		BusyStartTime = FPlatformTime::Seconds();
+		NumFinishedSinceBusy = 0;
+	}
+
+	// The tasks keep the service alive in case they outlive whoever submitted them
+	TSharedRef<FDungeonGenerationService, ESPMode::ThreadSafe> Service = AsShared();
+
+	Async(EAsyncExecution::ThreadPool, [Service, Settings, OnComplete = MoveTemp(OnComplete)]() mutable
+	{
+		FDungeonLayoutRef Layout = Service->GenerateLayout(Settings);
+
+		AsyncTask(ENamedThreads::GameThread, [Service, Layout, OnComplete = MoveTemp(OnComplete)]()
+		{
+			OnComplete(Layout);
+			Service->OnSubmittedLayoutFinished();
+		});
+	});
+}
+
+void FDungeonGenerationService::GenerateBatch(const TArray<FDungeonLayoutSettings>& Jobs, TArray<FDungeonLayoutPtr>& OutLayouts)
+{
+	OutLayouts.Reset();
+	OutLayouts.SetNum(Jobs.Num());
+
+	double StartTime = FPlatformTime::Seconds();
+
+	ParallelFor(Jobs.Num(), [this, &Jobs, &OutLayouts](int32 Index)
+	{
+		OutLayouts[Index] = GenerateLayout(Jobs[Index]);
+	});
+
+	ReportThroughput(Jobs.Num(), FPlatformTime::Seconds() - StartTime);
+}
+
+FDungeonLayoutRef FDungeonGenerationService::GenerateLayout(const FDungeonLayoutSettings& Settings)
+{
+	TUniquePtr<FDungeonLayoutGenerator> Generator;
+
+	{
+		FScopeLock Lock(&GeneratorsLock);
+
+		if (IdleGenerators.Num() > 0)
+		{
+			Generator = IdleGenerators.Pop(false);
+		}
+	}
+
+	if (!Generator)
+	{
+		Generator = MakeUnique<FDungeonLayoutGenerator>();
+	}
+
+	FDungeonLayoutRef Layout = Generator->Generate(Settings);
+
+	{
+		FScopeLock Lock(&GeneratorsLock);
+		IdleGenerators.Add(MoveTemp(Generator));
+	}
+
+	return Layout;
+}
+
+void FDungeonGenerationService::OnSubmittedLayoutFinished()
+{
+	NumFinishedSinceBusy++;
+
+	if (--NumInFlight == 0)
+	{
+		ReportThroughput(NumFinishedSinceBusy, FPlatformTime::Seconds() - BusyStartTime);
+	}
+}
+
+void FDungeonGenerationService::ReportThroughput(int32 NumLayouts, double Seconds)
+{
+	int32 NumCores = FMath::Max(FPlatformMisc::NumberOfCores(), 1);
+	LastThroughput = Seconds > 0.0 ? NumLayouts / Seconds / NumCores : 0.0;
+
+	UE_LOG(LogDungeonGenerationService, Log, TEXT("Generated %d dungeon layouts in %.3fs, %.2f dungeons per second per core over %d cores"), NumLayouts, Seconds, LastThroughput, NumCores);
+}
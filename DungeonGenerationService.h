@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+#include "DungeonLayout.h"
+
+/**
+ * Generates dungeon layouts on worker threads so many generators, such as one per match on a server, don't queue up on the game thread.
+ * Shared by every generator in the process. Each worker reuses an FDungeonLayoutGenerator so its scratch buffers stay allocated.
+ */
+class DUNGEON_CPP_API FDungeonGenerationService : public TSharedFromThis<FDungeonGenerationService, ESPMode::ThreadSafe>
+{
+public:
+
+	/** Returns the service shared by every generator */
+	static FDungeonGenerationService& Get();
+
+	/**
+	 * Queues a layout to be generated on the thread pool. OnComplete is called on the game thread with the finished layout.
+	 * Must be called on the game thread.
+	 */
+	void Submit(const FDungeonLayoutSettings& Settings, TFunction<void(FDungeonLayoutRef)> OnComplete);
+
+	/** Generates every layout before returning, spread across the task graph's worker threads */
+	void GenerateBatch(const TArray<FDungeonLayoutSettings>& Jobs, TArray<FDungeonLayoutPtr>& OutLayouts);
+
+	/** Returns the dungeons per second per core measured over the last batch, or the last time the queue was emptied */
+	FORCEINLINE double GetLastThroughput() const { return LastThroughput; }
+
+private:
+
+	/** Generates a single layout with one of the IdleGenerators, safe to call from any thread */
+	FDungeonLayoutRef GenerateLayout(const FDungeonLayoutSettings& Settings);
+
+	/** Records a submitted layout as finished and reports the throughput once the queue is empty */
+	void OnSubmittedLayoutFinished();
+
+	/** Works out and logs the dungeons per second per core for NumLayouts generated in Seconds */
+	void ReportThroughput(int32 NumLayouts, double Seconds);
+
+	/** Guards the IdleGenerators */
+	FCriticalSection GeneratorsLock;
+
+	/** Layout generators not being used by a worker */
+	TArray<TUniquePtr<FDungeonLayoutGenerator>> IdleGenerators;
+
+	/** The number of submitted layouts that haven't been handed back yet, only used on the game thread */
+	int32 NumInFlight = 0;
+
+	/** When the queue last went from empty to busy and how many layouts have finished since */
+	double BusyStartTime = 0.0;
+	int32 NumFinishedSinceBusy = 0;
+
+	double LastThroughput = 0.0;
+};
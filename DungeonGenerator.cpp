@@ -1,625 +1,2455 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-
-#include "DungeonGenerator.h"
-#include "Components/InstancedStaticMeshComponent.h"
-#include "Kismet/KismetMathLibrary.h"
-#include "Engine/Engine.h"
-#include "Engine/World.h"
-#include "DrawDebugHelpers.h"
-
-// Sets default values
-ADungeonGenerator::ADungeonGenerator()
-{
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = false;
-
-	// Configure defaults
-	TileSize = 600;
-	MinRoomSize = 3;
-	MaxRoomSize = 6;
-	NumberOfRooms = 15;
-	MinRoomDistance = 1;
-	MaxRoomDistance = 3;
-	StreamInput = 0;
-	StreamInput = 0;
-
-	
-}
-
-// Called when the game starts or when spawned
-void ADungeonGenerator::BeginPlay()
-{
-	Super::BeginPlay();	
-
-	Stream = InitializeStream(StreamInput);
-
-	// Create the constant InstancedStaticMeshComponents
-	CreateInstancedStaticMeshComponents(CorridorFloorTileMeshes, CorridorFloorTiles);
-	CreateInstancedStaticMeshComponents(CorridorWallTileMeshes, CorridorWallTiles);
-	CreateInstancedStaticMeshComponents(CorridorCeilingTileMeshes, CorridorCeilingTiles);
-
-	// Create array of rooms that can be placed in the world
-	while (Rooms.Num() < NumberOfRooms)
-	{
-		TryPlaceRoom();
-	}
-
-	// Move dungeon so lowest room connects to starting area
-	MoveDungeonToStartArea();
-
-	CreateCorridors(RoomConnections);
-	SpawnRooms();
-	SpawnLightsInRooms();
-}
-
-URoom* ADungeonGenerator::TryPlaceRoom()
-{
-	URoom* NewRoom = GenerateNewRoom();
-
-	if (Rooms.Num() > 0)
-	{
-		// Pick a random room to place the NewRoom next to
-		int32 RoomIndexToConnectRoomTo = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, Rooms.Num() - 1, Stream);
-		URoom* ConnectingRoom = Rooms[RoomIndexToConnectRoomTo];
-
-		int32 SpaceBetweenRooms = UKismetMathLibrary::RandomIntegerInRangeFromStream(MinRoomDistance, MaxRoomDistance, Stream);
-		FVector NewRoomPosition = FVector(0.f);
-		int32 RandomPosition = 0;
-
-		// Pick a random direction to spawn the room
-		int32 DirectionToPlaceRoom = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, 3, Stream);
-		switch (DirectionToPlaceRoom)
-		{
-		case 0: // Top
-			RandomPosition = GetRandomPointWhereRoomsOverlap(ConnectingRoom->Position.Y, ConnectingRoom->GetRoomMax().Y, NewRoom->Size.Y);
-			NewRoomPosition = FVector(ConnectingRoom->GetRoomMax().X + SpaceBetweenRooms, RandomPosition, 0.f);
-			break;
-		case 1: // Right
-			RandomPosition = GetRandomPointWhereRoomsOverlap(ConnectingRoom->Position.X, ConnectingRoom->GetRoomMax().X, NewRoom->Size.X);
-			NewRoomPosition = FVector(RandomPosition, ConnectingRoom->GetRoomMax().Y + SpaceBetweenRooms, 0.f);
-			break;
-		case 2: // Bottom
-			RandomPosition = GetRandomPointWhereRoomsOverlap(ConnectingRoom->Position.Y, ConnectingRoom->GetRoomMax().Y, NewRoom->Size.Y);
-			NewRoomPosition = FVector(ConnectingRoom->Position.X - NewRoom->Size.X - SpaceBetweenRooms, RandomPosition, 0.f);
-			break;
-		case 3: // Left
-			RandomPosition = GetRandomPointWhereRoomsOverlap(ConnectingRoom->Position.X, ConnectingRoom->GetRoomMax().X, NewRoom->Size.X);
-			NewRoomPosition = FVector(RandomPosition, ConnectingRoom->Position.Y - NewRoom->Size.Y - SpaceBetweenRooms, 0.f);
-			break;
-		default:
-			break;
-		}
-
-		NewRoom->SetRoomPosition(NewRoomPosition);
-
-		CheckRoomIsNotOverlappingOtherRooms(NewRoom);
-
-		if (NewRoom->bCanBePlaced)
-		{
-			Rooms.Add(NewRoom);
-
-			FConnectingRoom RoomConnection;
-			RoomConnection.RoomAIndex = ConnectingRoom->Index;
-			RoomConnection.RoomBIndex = NewRoom->Index;
-
-			RoomConnections.Add(RoomConnection);
-		}
-	}
-	else
-	{
-		Rooms.Add(NewRoom);
-
-		NewRoom->SetRoomPosition(FVector(0.f));
-	}
-
-	return NewRoom;
-}
-
-URoom* ADungeonGenerator::GenerateNewRoom()
-{
-	float RoomSizeX = UKismetMathLibrary::RandomIntegerInRangeFromStream(MinRoomSize, MaxRoomSize, Stream);
-	float RoomSizeY = UKismetMathLibrary::RandomIntegerInRangeFromStream(MinRoomSize, MaxRoomSize, Stream);
-
-	URoom* NewRoom = NewObject<URoom>(this);
-	NewRoom->Size = FVector(RoomSizeX, RoomSizeY, 0.f);
-	NewRoom->bCanBePlaced = false;
-	NewRoom->Index = Rooms.Num();
-
-	return NewRoom;
-}
-
-void ADungeonGenerator::CheckRoomIsNotOverlappingOtherRooms(URoom* &RoomToCheck)
-{
-	for(URoom* CurrentRoom : Rooms)
-	{
-		// Check if the two rooms overlap on the X
-		float X1 = FMath::Max(CurrentRoom->Position.X, RoomToCheck->Position.X);
-		float X2 = FMath::Min(CurrentRoom->GetRoomMax().X, RoomToCheck->GetRoomMax().X);
-		
-		bool OverlappingOnX = X1 <= X2;
-
-		// Check if the two rooms overlap on the Y
-		float Y1 = FMath::Max(CurrentRoom->Position.Y, RoomToCheck->Position.Y);
-		float Y2 = FMath::Min(CurrentRoom->GetRoomMax().Y, RoomToCheck->GetRoomMax().Y);
-
-		bool OverlappingOnY = Y1 <= Y2;
-
-		// If they overlap on both the X and the Y then the rooms are overlapping
-		if (OverlappingOnX && OverlappingOnY)
-		{
-			RoomToCheck->bCanBePlaced = false;
-			return;
-		}
-	}
-	
-	RoomToCheck->bCanBePlaced = true;
-}
-
-void ADungeonGenerator::SpawnRooms()
-{
-	for (URoom* Room : Rooms)
-	{
-		FRoomType* RoomType = PickRandomRoomTypeForRoom(Room);
-		CreateInstancedStaticMeshesForCurrentRoom(RoomType);
-
-		for (float x = 0; x < Room->Size.X; x++)
-		{
-			for (float y = 0; y < Room->Size.Y; y++)
-			{
-				FVector ActualRoomPosition = Room->Position * TileSize;
-				FVector PositionOfTile = ActualRoomPosition + FVector(x * TileSize, y * TileSize, 0.f);
-
-				// Spawn floor tile				
-				SpawnRandomTile(RoomFloorTiles, FTransform(PositionOfTile));
-
-				// Spawn ceiling tile				
-				SpawnRandomTile(RoomCeilingTiles, FTransform(PositionOfTile + FVector(0.f, 0.f, TileSize * Room->WallHeight)));
-			}
-		}
-
-		SpawnRoomWalls(Room);
-	}	
-}
-
-void ADungeonGenerator::SpawnRoomWalls(URoom* &Room)
-{
-	FRotator WallRotation = FRotator(0.f);
-
-	// Spawn wall tiles along bottom wall
-	FVector StartPoint = Room->Position;
-	FVector EndPoint = Room->Position + FVector(0.f, Room->Size.Y, 0.f);
-	SpawnWall(StartPoint, EndPoint, WallRotation, Room->WallHeight, Room->DoorLocations);
-
-	// Spawn wall tiles along top wall
-	WallRotation = FRotator(0.f, 180.f, 0.f);
-	StartPoint = Room->Position + FVector(Room->Size.X, Room->Size.Y, 0.f);
-	EndPoint = Room->Position + FVector(Room->Size.X, 0.f, 0.f);
-	SpawnWall(StartPoint, EndPoint, WallRotation, Room->WallHeight, Room->DoorLocations);
-
-	// Spawn wall tiles along left wall
-	WallRotation = FRotator(0.f, 90.f, 0.f);
-	StartPoint = Room->Position + FVector(Room->Size.X, 0.f, 0.f);
-	EndPoint = Room->Position;
-	SpawnWall(StartPoint, EndPoint, WallRotation, Room->WallHeight, Room->DoorLocations);
-
-	// Spawn wall tiles along right wall
-	WallRotation = FRotator(0.f, -90.f, 0.f);
-	StartPoint = Room->Position + FVector(0.f, Room->Size.Y, 0.f);;
-	EndPoint = Room->GetRoomMax();
-	SpawnWall(StartPoint, EndPoint, WallRotation, Room->WallHeight ,Room->DoorLocations);
-}
-
-void ADungeonGenerator::SpawnWall(FVector &StartPoint, FVector &EndPoint, FRotator &Rotation, const int32 &Height, TArray<FVector> DoorLocations)
-{
-	float WallLength = (StartPoint - EndPoint).Size();
-	bool SpawnAlongX = StartPoint.X != EndPoint.X;
-	bool Subract = false;
-
-	// Check if we are placing tiles forward or backward
-	if (SpawnAlongX)
-		Subract = StartPoint.X > EndPoint.X;
-	else
-		Subract = StartPoint.Y > EndPoint.Y;
-
-	for (float i = 0; i < WallLength; i++)
-	{
-		for (int32 h = 0; h < Height; h++)
-		{
-			float X = StartPoint.X;
-			float Y = StartPoint.Y;
-
-			if (SpawnAlongX)
-				Subract ? X -= i : X += i;
-			else
-				Subract ? Y -= i : Y += i;
-
-			FVector Location = FVector(X, Y, h) * TileSize;
-
-			TArray<FRandomTile> WallTilesToSpawn = RoomWallTiles;
-			TArray<FRandomTile> WallAdditionTilesToSpawn = RoomWallAdditionTiles;
-
-			// Check if the current location should be a door
-			if (DoorLocations.Contains(FVector(X, Y, h)))
-			{		
-				WallTilesToSpawn = RoomDoorTiles;
-				WallAdditionTilesToSpawn = RoomDoorAdditionTiles;				
-			}
-
-			// Spawn wall tile
-			SpawnRandomTile(WallTilesToSpawn, FTransform(Rotation, Location));
-
-			// Spawn wall addition tile
-			SpawnAllTiles(WallAdditionTilesToSpawn, FTransform(Rotation, Location), h);
-		}
-	}
-}
-
-void ADungeonGenerator::CreateInstancedStaticMeshComponents(const TArray<FRandomTile>& TileMeshes, TArray<FRandomTile>& InstancedTileMeshes)
-{
-	// Empty previously used meshes
-	InstancedTileMeshes.Empty();
-
-	if (TileMeshes.Num() > 0)
-	{
-		for (FRandomTile Tile : TileMeshes)
-		{
-			UInstancedStaticMeshComponent* Instance = NewObject<UInstancedStaticMeshComponent>(this);
-			Instance->RegisterComponent();
-			Instance->SetStaticMesh(Tile.Mesh);
-			Instance->AttachTo(GetRootComponent());
-
-			Tile.InstancedMeshComponent = Instance;
-
-			InstancedTileMeshes.Add(Tile);
-		}
-	}
-}
-
-void ADungeonGenerator::CreateCorridors(const TArray<FConnectingRoom>& ConnectingRooms)
-{
-	// Sort the URooms array by the Index property so rooms can easily be pulled from the array by index
-	Rooms.Sort([](const URoom& A, const URoom& B) { return A.Index < B.Index; });
-	
-	// Loop through the connecting rooms
-	for (FConnectingRoom RoomConnection : ConnectingRooms)
-	{
-		// Get the two connecting rooms by their index
-		URoom* RoomA = Rooms[RoomConnection.RoomAIndex];
-		URoom* RoomB = Rooms[RoomConnection.RoomBIndex];
-
-		// Find the min and max of the room positions and Maximums to calculate where the rooms are in 
-		float MaxOriginX = FMath::Max(RoomA->Position.X, RoomB->Position.X);
-		float MinMaximumX = FMath::Min(RoomA->GetRoomMax().X, RoomB->GetRoomMax().X);
-
-		float MaxOriginY = FMath::Max(RoomA->Position.Y, RoomB->Position.Y);
-		float MinMaximumY = FMath::Min(RoomA->GetRoomMax().Y, RoomB->GetRoomMax().Y);
-
-		// Check if rooms are next to each other on the Y axis
-		if (MaxOriginX < MinMaximumX && MaxOriginY > MinMaximumY)
-		{			
-			URoom* LeftRoom;
-			URoom* RightRoom;
-
-			// Check which room is on the right on the Y axis
-			if (RoomB->Position.Y > RoomA->GetRoomMax().Y)
-			{
-				RightRoom = RoomB;
-				LeftRoom = RoomA;
-			}
-			else
-			{
-				RightRoom = RoomA;
-				LeftRoom = RoomB;
-			}
-
-			// Pick the random point between the points the rooms overlap on the X
-			float CorridorX = UKismetMathLibrary::RandomIntegerInRangeFromStream(MaxOriginX, MinMaximumX - 1, Stream);
-
-			// Corridor will go from the right side of the left room to the right room at the random point on the X
-			FVector CorridorStart = FVector(CorridorX, LeftRoom->GetRoomMax().Y, 0.f);
-			FVector CorridorEnd = FVector(CorridorX, RightRoom->Position.Y, 0.f);
-
-			// Add doors location to rooms
-			LeftRoom->DoorLocations.Add(CorridorStart);
-
-			FVector RightRoomDoorLocation = CorridorEnd;
-			RightRoomDoorLocation.X += 1;
-			RightRoom->DoorLocations.Add(RightRoomDoorLocation);
-
-			SpawnCorridorTiles(CorridorStart, CorridorEnd);
-		}
-		// else rooms are aligned on the X axis
-		else
-		{
-			URoom* TopRoom;
-			URoom* BottomRoom;
-
-			// Check which room is higher on the X axis
-			if (RoomB->Position.X > RoomA->GetRoomMax().X)
-			{
-				TopRoom = RoomB;
-				BottomRoom = RoomA;
-			}
-			else
-			{
-				TopRoom = RoomA;
-				BottomRoom = RoomB;
-			}
-
-			// Pick the random point between the points the rooms overlap on the Y
-			float CorridorY = UKismetMathLibrary::RandomIntegerInRangeFromStream(MaxOriginY, MinMaximumY - 1, Stream);			
-
-			// Corridor will go from the top of the bottom room to the top room at the random point on the Y
-			FVector CorridorStart = FVector(BottomRoom->GetRoomMax().X, CorridorY, 0.f);
-			FVector CorridorEnd = FVector(TopRoom->Position.X, CorridorY, 0.f);
-
-			// Add door locations to rooms
-			FVector BottomRoomDoorLocation = CorridorStart;
-			BottomRoomDoorLocation.Y += 1;
-			BottomRoom->DoorLocations.Add(BottomRoomDoorLocation);
-			TopRoom->DoorLocations.Add(CorridorEnd);
-
-			SpawnCorridorTiles(CorridorStart, CorridorEnd);
-		}
-	}
-}
-
-void ADungeonGenerator::SpawnCorridorTiles(const FVector &CorridorStart, const FVector &CorridorEnd)
-{	
-	float NumberOfTiles = (CorridorStart - CorridorEnd).Size() == 0 ? 1 : (CorridorStart - CorridorEnd).Size();
-
-	for (int32 i = 0; i <= NumberOfTiles - 1; i++)
-	{
-		FVector PositionOfTile;
-		FVector OpositeWallPosition;
-		FVector WallPosition;
-		FRotator WallRotation = FRotator(0.f, 0.f, 0.f);
-		FRotator OpositeWallRotation = FRotator(0.f, 180.f, 0.f);
-		if (CorridorStart.X == CorridorEnd.X)
-		{
-			// Tiles being placed along the Y axis
-			PositionOfTile = FVector(CorridorStart.X, CorridorStart.Y + i, 0.f) * TileSize;
-						
-			WallPosition = FVector(CorridorStart.X, CorridorEnd.Y - i - 1, 0.f) * TileSize;
-			OpositeWallPosition = FVector(CorridorStart.X + 1, CorridorStart.Y + i + 1, 0.f) * TileSize;
-		}
-		else
-		{
-			// Tiles being placed along the X axis
-			PositionOfTile = FVector(CorridorStart.X + i, CorridorStart.Y, 0.f) * TileSize;
-
-			WallPosition = FVector(CorridorEnd.X - i, CorridorEnd.Y, 0.f) * TileSize;
-			OpositeWallPosition = FVector(CorridorStart.X + i, CorridorStart.Y + 1, 0.f) * TileSize;
-
-			WallRotation = FRotator(0.f, 90.f, 0.f);
-			OpositeWallRotation = FRotator(0.f, -90.f, 0.f);
-		}
-
-		SpawnRandomTile(CorridorFloorTiles, FTransform(PositionOfTile));
-
-		SpawnRandomTile(CorridorWallTiles, FTransform(WallRotation, WallPosition));
-		SpawnRandomTile(CorridorWallTiles, FTransform(OpositeWallRotation, OpositeWallPosition));
-
-		SpawnRandomTile(CorridorCeilingTiles, FTransform(PositionOfTile + FVector(0.f, 0.f, TileSize)));
-	}
-}
-
-void ADungeonGenerator::SpawnRandomTile(const TArray<FRandomTile> &InstancedTileMeshesArray, const FTransform &AtLocation)
-{
-	if (InstancedTileMeshesArray.Num() > 0)
-	{
-		bool SpawnTile = false;
-
-		while (!SpawnTile)
-		{
-			int32 TileToSpawnIndex = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, InstancedTileMeshesArray.Num() - 1, Stream);
-
-			// Check the tiles probablity isn't 0 to prevent infinite loop
-			float Probability = InstancedTileMeshesArray[TileToSpawnIndex].Probability == 0 ? 1 : InstancedTileMeshesArray[TileToSpawnIndex].Probability;
-
-			SpawnTile = UKismetMathLibrary::RandomBoolWithWeightFromStream(Probability, Stream);
-
-			if (SpawnTile)
-			{
-				InstancedTileMeshesArray[TileToSpawnIndex].InstancedMeshComponent->AddInstance(AtLocation);
-			}
-		}
-	}
-}
-
-void ADungeonGenerator::SpawnAllTiles(const TArray<FRandomTile>& InstancedTileMeshesArray, const FTransform& AtLocation, const int32 CurrentHeight)
-{
-	if (InstancedTileMeshesArray.Num() > 0)
-	{
-		for (FRandomTile Tile : InstancedTileMeshesArray)
-		{
-			Tile.InstancedMeshComponent->AddInstance(AtLocation);
-		}
-	}
-}
-
-void ADungeonGenerator::MoveDungeonToStartArea()
-{
-	URoom* LowestRoom = Rooms[0];
-
-	for (URoom* Room : Rooms)
-	{
-		if (Room->Position.X < LowestRoom->Position.X)
-		{
-			LowestRoom = Room;
-		}
-	}
-
-	FVector LowestPoint = FVector(LowestRoom->Position.X, LowestRoom->Position.Y + FMath::FloorToFloat(LowestRoom->Size.Y / 2), 0.f);
-
-	// Add door between the starting area and the first room
-	LowestRoom->DoorLocations.Add(LowestPoint);
-
-	DungeonOffset = LowestPoint * TileSize;
-	FVector EndPosition = GetActorLocation() - DungeonOffset;
-	
-	SetActorLocation(EndPosition);
-}
-
-FRoomType* ADungeonGenerator::PickRandomRoomTypeForRoom(URoom*& CurrentRoom)
-{
-	FRoomType* SelectedRoomType = nullptr;
-
-	if (RoomTypesDataTable)
-	{
-		auto RowNames = RoomTypesDataTable->GetRowNames();
-		const FString ContextString(TEXT("Selected Room Context"));
-		bool RoomSelected = false;
-		FName RoomTypeRowName;
-
-		// Randomly select a room from the datatable using it's probability
-		while (!RoomSelected)
-		{
-			int32 RoomIndex = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, RowNames.Num() - 1, Stream);
-			RoomTypeRowName = RowNames[RoomIndex];
-			SelectedRoomType = RoomTypesDataTable->FindRow<FRoomType>(RoomTypeRowName, ContextString, true);
-			float Probability = SelectedRoomType->Probability == 0 ? 1 : SelectedRoomType->Probability;
-
-			RoomSelected = UKismetMathLibrary::RandomBoolWithWeightFromStream(Probability, Stream);
-		}
-
-		CurrentRoom->SetWallHeight(SelectedRoomType->WallHeight);
-		CurrentRoom->RoomTypeRowName = RoomTypeRowName;
-	}
-
-	return SelectedRoomType;
-}
-
-void ADungeonGenerator::CreateInstancedStaticMeshesForCurrentRoom(FRoomType* &SelectedRoomType)
-{
-	if (SelectedRoomType)
-	{
-		// Create instanced static meshes of the meshes selected in the row
-		CreateInstancedStaticMeshComponents(SelectedRoomType->FloorTileMeshes, RoomFloorTiles);
-		CreateInstancedStaticMeshComponents(SelectedRoomType->WallTileMeshes, RoomWallTiles);
-		CreateInstancedStaticMeshComponents(SelectedRoomType->CeilingTileMeshes, RoomCeilingTiles);
-		CreateInstancedStaticMeshComponents(SelectedRoomType->DoorTileMeshes, RoomDoorTiles);
-		CreateInstancedStaticMeshComponents(SelectedRoomType->WallAdditionTileMeshes, RoomWallAdditionTiles);
-		CreateInstancedStaticMeshComponents(SelectedRoomType->DoorAdditionTileMeshes, RoomDoorAdditionTiles);
-	}
-}
-
-void ADungeonGenerator::SpawnLightsInRooms()
-{
-	if(RoomTypesDataTable)
-	{
-		const FString ContextString(TEXT("Selected Room Context"));
-
-		for (URoom* Room : Rooms)
-		{
-			FRoomType* RoomType = RoomTypesDataTable->FindRow<FRoomType>(Room->RoomTypeRowName, ContextString);
-
-			if (RoomType->LightActors.Num())
-			{
-				for (FLightSource LightActor : RoomType->LightActors)
-				{
-					FActorSpawnParameters SpawnParams;
-					int32 GapBetweenLights = LightActor.TileDistanceBetweenNext == 0 ? 1 : LightActor.TileDistanceBetweenNext;
-
-					switch (LightActor.Location)
-					{
-					case EObjectLocation::EOL_AroundRoom:
-					{
-						FVector StartLocation = Room->Position;
-						FVector EndLocation = FVector(Room->GetRoomMax().X, Room->Position.Y, 0.f);
-
-						// Left wall
-						SpawnLightsAlongLength(StartLocation, EndLocation, FRotator(0.f, 90.f, 0.f), GapBetweenLights, LightActor.LightActor);
-						// Right wall
-						SpawnLightsAlongLength(FVector(Room->Position.X, Room->GetRoomMax().Y, 0.f), FVector(Room->GetRoomMax().X, Room->GetRoomMax().Y, 0.f), FRotator(0.f, 270.f, 0.f), GapBetweenLights, LightActor.LightActor);
-						// Bottom wall
-						SpawnLightsAlongLength(StartLocation, FVector(Room->Position.X, Room->GetRoomMax().Y, 0.f), FRotator(0.f), GapBetweenLights, LightActor.LightActor);
-						// Top wall
-						SpawnLightsAlongLength(FVector(Room->GetRoomMax().X, Room->Position.Y, 0.f), FVector(Room->GetRoomMax().X, Room->GetRoomMax().Y, 0.f), FRotator(0.f, 180.f, 0.f), GapBetweenLights, LightActor.LightActor);
-					}
-						break;
-					case EObjectLocation::EOL_Ceiling: // Spawn ceiling light in the centre of the room on the ceiling
-					{
-						FVector StartLocation(0.f);
-						FVector EndLocation(0.f);
-
-						// Find which axis the room is longer in and spawn them along that axis
-						if (Room->Size.X >= Room->Size.Y)
-						{
-							float Y = Room->Position.Y + (Room->Size.Y / 2);
-							StartLocation = FVector(Room->Position.X, Y, RoomType->WallHeight);
-							EndLocation = FVector(Room->GetRoomMax().X, Y, RoomType->WallHeight);
-						}
-						else
-						{
-							float X = Room->Position.X + (Room->Size.X / 2);
-							StartLocation = FVector(X, Room->Position.Y, RoomType->WallHeight);
-							EndLocation = FVector(X, Room->GetRoomMax().Y, RoomType->WallHeight);
-						}
-
-						SpawnLightsAlongLength(StartLocation, EndLocation, FRotator(0.f), GapBetweenLights, LightActor.LightActor);
-					}
-						break;
-					default:
-						break;
-					}
-				}
-			}
-		}
-	}
-}
-
-int32 ADungeonGenerator::GetRandomPointWhereRoomsOverlap(float ConnectingRoomPosition, float ConnectingRoomMaximum, float NewRoomSize)
-{
-	int32 MinYPosition = (ConnectingRoomPosition - NewRoomSize) + 1;
-	int32 MaxYPosition = ConnectingRoomMaximum - 1;
-	return UKismetMathLibrary::RandomIntegerInRangeFromStream(MinYPosition, MaxYPosition, Stream);
-}
-
-void ADungeonGenerator::SpawnLightsAlongLength(FVector StartLocation, FVector EndLocation, FRotator Rotation, int32 GapBetweenLights, TSubclassOf<AActor> ActorToSpawn)
-{
-	int32 Length = (StartLocation - EndLocation).Size();
-
-	int32 NumberOfTilesNeeded = FMath::FloorToInt(Length / GapBetweenLights) * GapBetweenLights;
-	if (NumberOfTilesNeeded == Length)
-		NumberOfTilesNeeded -= GapBetweenLights;
-	int32 TilesOnEitherSide = (Length - NumberOfTilesNeeded) / 2;
-
-	// If length can fit more than one light with GapBetweenLights between them
-	if (TilesOnEitherSide > 0)
-	{
-		for (int32 i = TilesOnEitherSide; i < Length; i += GapBetweenLights)
-		{
-			FVector LightLocation = StartLocation * TileSize;
-
-			if (StartLocation.X == EndLocation.X)
-			{
-				LightLocation.Y += TileSize * i;
-			}
-			else
-			{
-				LightLocation.X += TileSize * i;
-			}
-
-			LightLocation -= DungeonOffset;
-			GetWorld()->SpawnActor<AActor>(ActorToSpawn, LightLocation, Rotation);
-		}
-	}
-	else // else just spawn one light in the middle
-	{
-		FVector LightLocation = StartLocation * TileSize;
-		float Centre = Length / 2;
-		if (StartLocation.X == EndLocation.X)
-		{
-			LightLocation.Y += TileSize * Centre;
-		}
-		else
-		{
-			LightLocation.X += TileSize * Centre;
-		}
-
-		LightLocation -= DungeonOffset;
-		GetWorld()->SpawnActor<AActor>(ActorToSpawn, LightLocation, Rotation);
-	}
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonGenerator.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/BoxComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Texture2D.h"
+#include "ProceduralMeshComponent.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "DrawDebugHelpers.h"
+#include "DungeonLayoutSyncComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/Compression.h"
+#include "Misc/Crc.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "DungeonGenerationService.h"
+#include "PoissonDiskSampler.h"
+#include "RoomTemplate.h"
+#include "Async/ParallelFor.h"
+#include "Algo/BinarySearch.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#include "TimerManager.h"
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogDungeonGenerator, Log, All);
+
+/** Increase whenever the layout snapshot format changes */
+static const int32 LayoutSnapshotVersion = 2;
+
+/** The largest uncompressed snapshot and tile grid a client accepts, snapshots come from the network so nothing in them is trusted */
+static const int32 MaxLayoutSnapshotSize = 16 * 1024 * 1024;
+static const int32 MaxLayoutSnapshotTiles = 4 * 1024 * 1024;
+
+/** Stands in for the layout before one has been generated so the queries don't need to check for one */
+static FDungeonLayoutRef GetEmptyLayout()
+{
+	static FDungeonLayoutRef EmptyLayout = MakeShared<FDungeonLayout, ESPMode::ThreadSafe>();
+	return EmptyLayout;
+}
+
+#if WITH_EDITOR
+/** The seed previews use when the StreamInput is 0, so the preview doesn't change on every edit */
+static const int32 DefaultPreviewSeed = 1;
+#endif
+
+/** Rough costs used to estimate the memory of a dungeon */
+static const float GPUBytesPerInstance = 64.f;
+static const float CPUBytesPerInstance = 192.f;
+static const float CPUBytesPerComponent = 2048.f;
+
+/** Roughly how many Poisson disk points fit per square tile when they are one tile apart */
+static const float PoissonPointsPerArea = 0.7f;
+
+/** Returns the chance of a tile being kept once it has been picked, the same weight RandomBoolWithWeightFromStream uses */
+static float GetPickWeight(float Probability)
+{
+	return Probability == 0 ? 1.f : FMath::Clamp(Probability, 0.f, 1.f);
+}
+
+/** Returns the number of lights SpawnLightsAlongLength places along a wall of Length tiles */
+static int32 GetNumLightsAlongLength(int32 Length, int32 GapBetweenLights)
+{
+	int32 NumberOfTilesNeeded = (Length / GapBetweenLights) * GapBetweenLights;
+	if (NumberOfTilesNeeded == Length)
+		NumberOfTilesNeeded -= GapBetweenLights;
+	int32 TilesOnEitherSide = (Length - NumberOfTilesNeeded) / 2;
+
+	return TilesOnEitherSide > 0 ? (Length - 1 - TilesOnEitherSide) / GapBetweenLights + 1 : 1;
+}
+
+/** Picks a tile using its probability, returns INDEX_NONE if there are no tiles to pick from */
+static int32 PickRandomTileIndex(const TArray<FRandomTile>& Tiles, FRandomStream& Stream)
+{
+	if (Tiles.Num() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	while (true)
+	{
+		int32 TileIndex = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, Tiles.Num() - 1, Stream);
+
+		// Check the tiles probablity isn't 0 to prevent infinite loop
+		float Probability = Tiles[TileIndex].Probability == 0 ? 1 : Tiles[TileIndex].Probability;
+
+		if (UKismetMathLibrary::RandomBoolWithWeightFromStream(Probability, Stream))
+		{
+			return TileIndex;
+		}
+	}
+}
+
+// Sets default values
+ADungeonGenerator::ADungeonGenerator()
+{
+ 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Only the seed is replicated, every client generates the dungeon itself
+	bReplicates = true;
+	bAlwaysRelevant = true;
+
+	// Configure defaults
+	TileSize = 600;
+	MinRoomSize = 3;
+	MaxRoomSize = 6;
+	NumberOfRooms = 15;
+	MinRoomDistance = 1;
+	MaxRoomDistance = 3;
+	StreamInput = 0;
+	NumCulledInstances = 0;
+	bShareVariantComponents = false;
+	bCullTileInstances = false;
+	bTilesAffectNavigation = true;
+	bUseSimplifiedCollision = false;
+	bUseRoomProxies = false;
+	RoomProxyDistance = 8000.f;
+	CollisionThickness = 20.f;
+	CollisionProfileName = TEXT("BlockAll");
+	bRouteCorridors = false;
+	LoopConnectionRatio = 0.f;
+	MaxLoopCorridorLength = 6;
+	ConfigVersion = 0;
+	bGenerateAsync = false;
+	bEnforceBudget = false;
+	MaxBudgetSeedAttempts = 8;
+
+#if WITH_EDITORONLY_DATA
+	bPreviewInEditor = false;
+	PreviewDelay = 0.2f;
+#endif
+
+#if WITH_EDITOR
+	bPreviewNeedsLayout = false;
+#endif
+
+	Layout = GetEmptyLayout();
+	bLayoutGenerated = false;
+	bIsPreview = false;
+	LayoutRequestId = 0;
+	CurrentRoomProxy = nullptr;
+	MinimapTexture = nullptr;
+}
+
+// Called when the game starts or when spawned
+void ADungeonGenerator::BeginPlay()
+{
+	Super::BeginPlay();	
+
+	DungeonStartLocation = GetActorLocation();
+
+	if (HasAuthority())
+	{
+		Stream = InitializeStream(StreamInput);
+
+		if (bEnforceBudget)
+		{
+			SelectSeedWithinBudget();
+		}
+
+		ReplicatedSeed.Seed = Stream.GetInitialSeed();
+		ReplicatedSeed.ConfigVersion = ConfigVersion;
+
+		GenerateDungeon();
+	}
+	// The seed may have replicated before the actor began play
+	else if (ReplicatedSeed.ConfigVersion != INDEX_NONE)
+	{
+		GenerateFromReplicatedSeed();
+	}
+}
+
+void ADungeonGenerator::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ADungeonGenerator, ReplicatedSeed);
+}
+
+void ADungeonGenerator::OnRep_ReplicatedSeed()
+{
+	if (HasActorBegunPlay())
+	{
+		GenerateFromReplicatedSeed();
+	}
+}
+
+void ADungeonGenerator::GenerateFromReplicatedSeed()
+{
+	Stream = InitializeStream(ReplicatedSeed.Seed);
+
+	GenerateDungeon();
+}
+
+#if WITH_EDITOR
+void ADungeonGenerator::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	UWorld* World = GetWorld();
+
+	if (!World || World->WorldType != EWorldType::Editor)
+	{
+		return;
+	}
+
+	if (!bPreviewInEditor)
+	{
+		if (bIsPreview)
+		{
+			CancelPendingLayout();
+			ClearDungeon();
+			bIsPreview = false;
+		}
+
+		return;
+	}
+
+	// Only these change the layout, everything else just changes what is spawned on it
+	static const TSet<FName> LayoutPropertyNames =
+	{
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, MinRoomSize),
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, MaxRoomSize),
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, MinRoomDistance),
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, MaxRoomDistance),
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, NumberOfRooms),
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, bRouteCorridors),
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, LoopConnectionRatio),
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, MaxLoopCorridorLength),
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, StreamInput),
+		GET_MEMBER_NAME_CHECKED(ADungeonGenerator, bPreviewInEditor)
+	};
+
+	FName PropertyName = PropertyChangedEvent.MemberProperty ? PropertyChangedEvent.MemberProperty->GetFName() : NAME_None;
+	SchedulePreview(LayoutPropertyNames.Contains(PropertyName));
+}
+
+void ADungeonGenerator::SchedulePreview(bool bRegenerateLayout)
+{
+	if (!GEditor)
+	{
+		return;
+	}
+
+	bPreviewNeedsLayout |= bRegenerateLayout;
+
+	GEditor->GetTimerManager()->SetTimer(PreviewTimerHandle, FTimerDelegate::CreateUObject(this, &ADungeonGenerator::UpdatePreview), FMath::Max(PreviewDelay, KINDA_SMALL_NUMBER), false);
+}
+
+void ADungeonGenerator::UpdatePreview()
+{
+	if (!bPreviewInEditor || IsPendingKill())
+	{
+		return;
+	}
+
+	WatchRoomTypes();
+
+	bIsPreview = true;
+	DungeonStartLocation = GetActorLocation();
+
+	if (bPreviewNeedsLayout || !bLayoutGenerated)
+	{
+		bPreviewNeedsLayout = false;
+
+		Stream.Initialize(StreamInput != 0 ? StreamInput : DefaultPreviewSeed);
+		GenerateDungeon();
+	}
+	else
+	{
+		// Only the spawning changed so the current layout is spawned again, dropping any layout still being generated.
+		// Every instance buffer is rebuilt as room type and tile picks share one stream, so one change can move every pick after it
+		CancelPendingLayout();
+		OnLayoutGenerated(Layout.ToSharedRef());
+	}
+}
+
+void ADungeonGenerator::WatchRoomTypes()
+{
+	if (WatchedRoomTypes.Get() == RoomTypesDataTable)
+	{
+		return;
+	}
+
+	if (UDataTable* OldRoomTypes = WatchedRoomTypes.Get())
+	{
+		OldRoomTypes->OnDataTableChanged().Remove(RoomTypesChangedHandle);
+	}
+
+	WatchedRoomTypes = RoomTypesDataTable;
+	RoomTypesChangedHandle.Reset();
+
+	if (RoomTypesDataTable)
+	{
+		RoomTypesChangedHandle = RoomTypesDataTable->OnDataTableChanged().AddUObject(this, &ADungeonGenerator::OnRoomTypesChanged);
+	}
+}
+
+void ADungeonGenerator::OnRoomTypesChanged()
+{
+	if (bPreviewInEditor && bIsPreview)
+	{
+		SchedulePreview(false);
+	}
+}
+#endif
+
+void ADungeonGenerator::GenerateDungeon()
+{
+	FDungeonLayoutSettings Settings = MakeLayoutSettings();
+	int32 RequestId = CancelPendingLayout();
+
+	// The editor preview always generates on a worker so dragging a value doesn't stall the editor
+	if (bGenerateAsync || bIsPreview)
+	{
+		PendingLayoutCancelFlag = MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+		Settings.CancelFlag = PendingLayoutCancelFlag;
+
+		TWeakObjectPtr<ADungeonGenerator> WeakThis(this);
+
+		FDungeonGenerationService::Get().Submit(Settings, [WeakThis, RequestId](FDungeonLayoutRef NewLayout)
+		{
+			// Drop layouts that were replaced while they were being generated
+			if (WeakThis.IsValid() && WeakThis->LayoutRequestId == RequestId)
+			{
+				WeakThis->PendingLayoutCancelFlag.Reset();
+				WeakThis->OnLayoutGenerated(NewLayout);
+			}
+		});
+	}
+	else
+	{
+		OnLayoutGenerated(LayoutGenerator.Generate(Settings));
+	}
+}
+
+int32 ADungeonGenerator::CancelPendingLayout()
+{
+	if (PendingLayoutCancelFlag.IsValid())
+	{
+		*PendingLayoutCancelFlag = true;
+		PendingLayoutCancelFlag.Reset();
+	}
+
+	return ++LayoutRequestId;
+}
+
+FDungeonLayoutSettings ADungeonGenerator::MakeLayoutSettings() const
+{
+	FDungeonLayoutSettings Settings;
+	Settings.Seed = Stream.GetCurrentSeed();
+	Settings.NumberOfRooms = NumberOfRooms;
+	Settings.MinRoomSize = MinRoomSize;
+	Settings.MaxRoomSize = MaxRoomSize;
+	Settings.MinRoomDistance = MinRoomDistance;
+	Settings.MaxRoomDistance = MaxRoomDistance;
+	Settings.bRouteCorridors = bRouteCorridors;
+	Settings.LoopConnectionRatio = LoopConnectionRatio;
+	Settings.MaxLoopCorridorLength = MaxLoopCorridorLength;
+	Settings.ConfigVersion = ConfigVersion;
+	Settings.bRasterizeMinimap = GetNetMode() != NM_DedicatedServer;
+
+	return Settings;
+}
+
+void ADungeonGenerator::OnLayoutGenerated(FDungeonLayoutRef NewLayout)
+{
+	// Everything temporary made while spawning comes off the FMemStack and is freed in one go when this returns
+	FMemMark GenerationMark(FMemStack::Get());
+
+	ClearDungeon();
+	ApplyLayout(NewLayout);
+	SpawnDungeon();
+
+	if (!HasAuthority())
+	{
+		// Let the server check we ended up with the same layout, if the PlayerController isn't here yet it reports when it arrives
+		APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+		UDungeonLayoutSyncComponent* LayoutSync = PlayerController ? PlayerController->FindComponentByClass<UDungeonLayoutSyncComponent>() : nullptr;
+
+		if (LayoutSync)
+		{
+			LayoutSync->ReportLayout(this);
+		}
+	}
+	else
+	{
+		// Clients that finished first had their hashes kept until now
+		for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+		{
+			UDungeonLayoutSyncComponent* LayoutSync = It->IsValid() ? (*It)->FindComponentByClass<UDungeonLayoutSyncComponent>() : nullptr;
+
+			if (LayoutSync)
+			{
+				LayoutSync->OnServerLayoutGenerated(this);
+			}
+		}
+	}
+}
+
+void ADungeonGenerator::ApplyLayout(FDungeonLayoutRef NewLayout)
+{
+	Layout = NewLayout;
+
+	// The spawning stage works on URooms so it can record what it picks for each room
+	for (int32 RoomIndex = 0; RoomIndex < NewLayout->Rooms.Num(); RoomIndex++)
+	{
+		const FDungeonLayoutRoom& LayoutRoom = NewLayout->Rooms[RoomIndex];
+
+		URoom* Room = AcquireRoom();
+		Room->Index = RoomIndex;
+		Room->Position = LayoutRoom.GetPosition();
+		Room->Size = LayoutRoom.GetSize();
+
+		for (const FDungeonLayoutDoor& Door : NewLayout->GetRoomDoors(RoomIndex))
+		{
+			Room->DoorLocations.Add(Door.GetPivot());
+		}
+
+		Room->bCanBePlaced = true;
+
+		Rooms.Add(Room);
+	}
+
+	// Move dungeon so lowest room connects to starting area, previews stay where they are so the actor isn't moved in the level
+	DungeonOffset = bIsPreview ? FVector::ZeroVector : FVector(NewLayout->StartPoint.X, NewLayout->StartPoint.Y, 0.f) * TileSize;
+	SetActorLocation(DungeonStartLocation - DungeonOffset);
+
+	// Carry on from the point in the stream the layout finished at
+	Stream.Initialize(NewLayout->PostLayoutSeed);
+
+	bLayoutGenerated = true;
+}
+
+void ADungeonGenerator::SpawnDungeon()
+{
+	// Create the constant InstancedStaticMeshComponents
+	CreateInstancedStaticMeshComponents(CorridorFloorTileMeshes, CorridorFloorTiles);
+	CreateInstancedStaticMeshComponents(CorridorWallTileMeshes, CorridorWallTiles);
+	CreateInstancedStaticMeshComponents(CorridorCeilingTileMeshes, CorridorCeilingTiles);
+
+	SpawnCorridorTiles();
+	SpawnRooms();
+	PopulateRooms();
+	SubmitTileInstances();
+	CreateMinimapTexture();
+
+	// Actors spawned by a preview would be saved into the level
+	if (!bIsPreview)
+	{
+		SpawnLightsInRooms();
+	}
+
+	if (bUseSimplifiedCollision)
+	{
+		SpawnSimplifiedCollision();
+	}
+
+	if (bIsPreview)
+	{
+		// Keep the preview out of the saved level and play in editor copies
+		for (UActorComponent* Component : TileComponents)
+		{
+			Component->SetFlags(RF_Transient);
+		}
+
+		for (UActorComponent* Component : RoomProxyComponents)
+		{
+			Component->SetFlags(RF_Transient);
+		}
+
+		for (UActorComponent* Component : CollisionComponents)
+		{
+			Component->SetFlags(RF_Transient);
+		}
+	}
+}
+
+void ADungeonGenerator::ClearDungeon()
+{
+	for (UInstancedStaticMeshComponent* TileComponent : TileComponents)
+	{
+		if (IsValid(TileComponent))
+		{
+			TileComponent->DestroyComponent();
+		}
+	}
+
+	TileComponents.Reset();
+
+	for (UProceduralMeshComponent* RoomProxyComponent : RoomProxyComponents)
+	{
+		if (IsValid(RoomProxyComponent))
+		{
+			RoomProxyComponent->DestroyComponent();
+		}
+	}
+
+	RoomProxyComponents.Reset();
+
+	for (UBoxComponent* CollisionComponent : CollisionComponents)
+	{
+		if (IsValid(CollisionComponent))
+		{
+			CollisionComponent->DestroyComponent();
+		}
+	}
+
+	CollisionComponents.Reset();
+
+	for (AActor* SpawnedActor : SpawnedActors)
+	{
+		if (IsValid(SpawnedActor))
+		{
+			SpawnedActor->Destroy();
+		}
+	}
+
+	SpawnedActors.Reset();
+
+	// Keep the rooms to be reused by the next generation rather than leaving them for the garbage collector
+	RoomPool.Append(Rooms);
+	Rooms.Reset();
+	PendingTileInstances.Reset();
+	PendingCustomData.Reset();
+	MinimapPixels.Reset();
+	PropComponents.Reset();
+	SpawnPoints.Reset();
+	RoomSpawnPointStarts.Reset();
+
+	if (!bIsPreview)
+	{
+		SetActorLocation(DungeonStartLocation);
+	}
+
+	Layout = GetEmptyLayout();
+	bLayoutGenerated = false;
+}
+
+void ADungeonGenerator::BuildLayoutSnapshot(TArray<uint8>& OutSnapshot) const
+{
+	TArray<uint8> LayoutData;
+	FMemoryWriter Writer(LayoutData);
+
+	int32 SnapshotVersion = LayoutSnapshotVersion;
+	int32 Seed = Layout->PostLayoutSeed;
+	int32 NumRooms = Layout->Rooms.Num();
+	Writer << SnapshotVersion << Seed << NumRooms;
+
+	for (FDungeonLayoutRoom Room : Layout->Rooms)
+	{
+		Writer << Room.X << Room.Y << Room.SizeX << Room.SizeY;
+	}
+
+	int32 NumConnections = Layout->RoomConnections.Num();
+	Writer << NumConnections;
+
+	for (FConnectingRoom RoomConnection : Layout->RoomConnections)
+	{
+		Writer << RoomConnection.RoomAIndex << RoomConnection.RoomBIndex;
+	}
+
+	FIntPoint GridOrigin = Layout->TileGrid.Origin;
+	FIntPoint GridSize(Layout->TileGrid.Width, Layout->TileGrid.Height);
+	TArray<uint8> PackedTiles;
+	PackedTiles.SetNumUninitialized(Layout->TileGrid.Num());
+	Layout->TileGrid.PackTiles(0, Layout->TileGrid.Num(), PackedTiles.GetData());
+	Writer << GridOrigin << GridSize << PackedTiles;
+
+	// Most of the grid is empty so it compresses down to very little
+	int32 UncompressedSize = LayoutData.Num();
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedSize);
+
+	OutSnapshot.SetNumUninitialized(sizeof(int32) + CompressedSize);
+	FMemory::Memcpy(OutSnapshot.GetData(), &UncompressedSize, sizeof(int32));
+
+	if (!FCompression::CompressMemory(NAME_Zlib, OutSnapshot.GetData() + sizeof(int32), CompressedSize, LayoutData.GetData(), UncompressedSize))
+	{
+		OutSnapshot.Reset();
+		return;
+	}
+
+	OutSnapshot.SetNum(sizeof(int32) + CompressedSize);
+}
+
+bool ADungeonGenerator::ApplyLayoutSnapshot(const TArray<uint8>& Snapshot)
+{
+	FMemMark GenerationMark(FMemStack::Get());
+
+	const int32 HeaderSize = sizeof(int32);
+
+	if (Snapshot.Num() <= HeaderSize)
+	{
+		return false;
+	}
+
+	int32 UncompressedSize = 0;
+	FMemory::Memcpy(&UncompressedSize, Snapshot.GetData(), sizeof(int32));
+
+	if (UncompressedSize <= 0 || UncompressedSize > MaxLayoutSnapshotSize)
+	{
+		return false;
+	}
+
+	TArray<uint8> LayoutData;
+	LayoutData.SetNumUninitialized(UncompressedSize);
+
+	if (!FCompression::UncompressMemory(NAME_Zlib, LayoutData.GetData(), UncompressedSize, Snapshot.GetData() + HeaderSize, Snapshot.Num() - HeaderSize))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(LayoutData);
+
+	auto GetRemainingBytes = [&Reader]()
+	{
+		return Reader.TotalSize() - Reader.Tell();
+	};
+
+	int32 SnapshotVersion = 0;
+	int32 Seed = 0;
+	int32 NumRooms = 0;
+	Reader << SnapshotVersion << Seed << NumRooms;
+
+	// Every count is checked against the bytes left before anything is allocated for it
+	if (SnapshotVersion != LayoutSnapshotVersion || Reader.IsError() || NumRooms <= 0 || NumRooms > GetRemainingBytes() / int64(sizeof(FDungeonLayoutRoom)))
+	{
+		return false;
+	}
+
+	TSharedRef<FDungeonLayout, ESPMode::ThreadSafe> NewLayout = MakeShared<FDungeonLayout, ESPMode::ThreadSafe>();
+	NewLayout->Settings = MakeLayoutSettings();
+	NewLayout->Rooms.Reserve(NumRooms);
+
+	for (int32 RoomIndex = 0; RoomIndex < NumRooms && !Reader.IsError(); RoomIndex++)
+	{
+		FDungeonLayoutRoom& Room = NewLayout->Rooms.AddDefaulted_GetRef();
+		Reader << Room.X << Room.Y << Room.SizeX << Room.SizeY;
+	}
+
+	int32 NumConnections = 0;
+	Reader << NumConnections;
+
+	if (Reader.IsError() || NumConnections < 0 || NumConnections > GetRemainingBytes() / int64(2 * sizeof(int32)))
+	{
+		return false;
+	}
+
+	NewLayout->RoomConnections.Reserve(NumConnections);
+
+	for (int32 ConnectionIndex = 0; ConnectionIndex < NumConnections && !Reader.IsError(); ConnectionIndex++)
+	{
+		FConnectingRoom RoomConnection;
+		Reader << RoomConnection.RoomAIndex << RoomConnection.RoomBIndex;
+
+		if (!NewLayout->Rooms.IsValidIndex(RoomConnection.RoomAIndex) || !NewLayout->Rooms.IsValidIndex(RoomConnection.RoomBIndex))
+		{
+			return false;
+		}
+
+		NewLayout->RoomConnections.Add(RoomConnection);
+	}
+
+	FIntPoint GridOrigin;
+	FIntPoint GridSize;
+	int32 NumPackedTiles = 0;
+	Reader << GridOrigin << GridSize << NumPackedTiles;
+
+	if (Reader.IsError() || GridSize.X <= 0 || GridSize.Y <= 0 || int64(GridSize.X) * GridSize.Y > MaxLayoutSnapshotTiles
+		|| NumPackedTiles != GridSize.X * GridSize.Y || NumPackedTiles > GetRemainingBytes()
+		|| int64(GridOrigin.X) + GridSize.X > MAX_int32 || int64(GridOrigin.Y) + GridSize.Y > MAX_int32)
+	{
+		return false;
+	}
+
+	// Read the tiles the same way the TArray was written, but only once its size is known to be sane
+	TArray<uint8> PackedTiles;
+	PackedTiles.SetNumUninitialized(NumPackedTiles);
+	Reader.Serialize(PackedTiles.GetData(), NumPackedTiles);
+
+	if (Reader.IsError())
+	{
+		return false;
+	}
+
+	// Every room has to lie inside the grid so marking it can't write outside the tiles
+	FIntRect GridRect(GridOrigin, GridOrigin + GridSize);
+
+	for (const FDungeonLayoutRoom& Room : NewLayout->Rooms)
+	{
+		FIntRect RoomRect = Room.GetRoomRect();
+
+		if (Room.SizeX <= 0 || Room.SizeY <= 0 || RoomRect.Min.X < GridRect.Min.X || RoomRect.Min.Y < GridRect.Min.Y
+			|| RoomRect.Max.X > GridRect.Max.X || RoomRect.Max.Y > GridRect.Max.Y)
+		{
+			return false;
+		}
+	}
+
+	FDungeonLayoutGenerator::AddStartArea(*NewLayout);
+
+	FDungeonTileGrid& TileGrid = NewLayout->TileGrid;
+	TileGrid.Initialize(GridOrigin, GridOrigin + GridSize);
+
+	if (!TileGrid.UnpackTiles(PackedTiles))
+	{
+		return false;
+	}
+
+	for (int32 RoomIndex = 0; RoomIndex < NewLayout->Rooms.Num(); RoomIndex++)
+	{
+		FIntRect RoomRect = NewLayout->Rooms[RoomIndex].GetRoomRect();
+		TileGrid.MarkRoom(RoomRect.Min, RoomRect.Size(), RoomIndex);
+	}
+
+	// Put the doors back on the rooms from the corridor tiles that open on to them
+	for (int32 Index = 0; Index < TileGrid.Num(); Index++)
+	{
+		for (uint8 Side = 0; Side < 4; Side++)
+		{
+			if (TileGrid.Tiles[Index].DoorMask & (1 << Side))
+			{
+				FIntPoint RoomTile = FDungeonTileGrid::GetNeighbour(TileGrid.ToCell(Index), static_cast<EDungeonDirection>(Side));
+				FIntPoint DoorPivot = FDungeonTileGrid::GetWallPivot(RoomTile, FDungeonTileGrid::GetOpposite(static_cast<EDungeonDirection>(Side)));
+
+				// A door has to open on to one of the rooms
+				if (!TileGrid.IsInside(RoomTile) || TileGrid.GetTile(RoomTile).RoomIndex == INDEX_NONE)
+				{
+					return false;
+				}
+
+				FDungeonLayoutGenerator::AddDoor(*NewLayout, TileGrid.GetTile(RoomTile).RoomIndex, DoorPivot);
+			}
+		}
+	}
+
+	// Carry on from the same point in the stream as the server so the tiles match
+	FDungeonLayoutGenerator::FinishLayout(*NewLayout, Seed);
+
+	// Anything still being generated from the seed is out of date now
+	CancelPendingLayout();
+
+	ClearDungeon();
+	ApplyLayout(NewLayout);
+	SpawnDungeon();
+
+	return true;
+}
+
+URoom* ADungeonGenerator::AcquireRoom()
+{
+	URoom* Room = RoomPool.Num() > 0 ? RoomPool.Pop(false) : NewObject<URoom>(this);
+
+	Room->Position = FIntPoint::ZeroValue;
+	Room->Size = FIntPoint::ZeroValue;
+	Room->bCanBePlaced = false;
+	Room->Index = INDEX_NONE;
+	Room->DoorLocations.Reset();
+	Room->WallHeight = 0;
+	Room->RoomTypeRowName = NAME_None;
+	Room->bHasTiles = false;
+
+	return Room;
+}
+
+void ADungeonGenerator::SpawnRooms()
+{
+	// Look the row names up once per generation rather than once per room
+	RoomTypeRowNames.Reset();
+	RoomTypeRows.Reset();
+
+	if (RoomTypesDataTable)
+	{
+		for (const TPair<FName, uint8*>& Row : RoomTypesDataTable->GetRowMap())
+		{
+			RoomTypeRowNames.Add(Row.Key);
+			RoomTypeRows.Add(reinterpret_cast<FRoomType*>(Row.Value));
+		}
+	}
+
+	int32 NumProxyTriangles = 0;
+
+	for (URoom* Room : Rooms)
+	{
+		FRoomType* RoomType = PickRandomRoomTypeForRoom(Room);
+
+		// The room's tile components hang off its proxy so they share its bounds and swap over at exactly the same distance
+		CurrentRoomProxy = nullptr;
+
+		if (bUseRoomProxies && RoomType)
+		{
+			NumProxyTriangles += CreateRoomProxy(Room, RoomType);
+		}
+
+		// Rooms that no room type fits are left empty, the tile arrays still hold the previous room's components
+		if (!RoomType)
+		{
+			continue;
+		}
+
+		if (RoomType->Template)
+		{
+			StampRoomTemplate(Room, RoomType->Template);
+			continue;
+		}
+
+		Room->bHasTiles = true;
+		CreateInstancedStaticMeshesForCurrentRoom(RoomType);
+
+		FIntPoint RoomMax = Room->GetRoomMax();
+
+		for (int32 x = Room->Position.X; x < RoomMax.X; x++)
+		{
+			for (int32 y = Room->Position.Y; y < RoomMax.Y; y++)
+			{
+				FVector PositionOfTile = FVector(x, y, 0.f) * TileSize;
+
+				// Spawn floor tile				
+				SpawnRandomTile(RoomFloorTiles, FTransform(PositionOfTile));
+
+				// Spawn ceiling tile				
+				SpawnRandomTile(RoomCeilingTiles, FTransform(PositionOfTile + FVector(0.f, 0.f, TileSize * Room->WallHeight)));
+			}
+		}
+
+		SpawnRoomWalls(Room);
+	}	
+
+	CurrentRoomProxy = nullptr;
+
+	if (RoomProxyComponents.Num() > 0)
+	{
+		UE_LOG(LogDungeonGenerator, Log, TEXT("Built %d room proxies with %d triangles"), RoomProxyComponents.Num(), NumProxyTriangles);
+	}
+}
+
+void ADungeonGenerator::PopulateRooms()
+{
+	static const FString ContextString(TEXT("Selected Room Context"));
+
+	// Every room gets its own stream seeded in room order, so the rooms can be sampled on any thread in any order and still come out the same
+	RoomPopulations.SetNum(Rooms.Num(), false);
+
+	for (int32 RoomIndex = 0; RoomIndex < Rooms.Num(); RoomIndex++)
+	{
+		FRoomPopulation& Population = RoomPopulations[RoomIndex];
+		const FName& RoomTypeRowName = Rooms[RoomIndex]->RoomTypeRowName;
+
+		// Rooms no room type fitted have no row, looking one up would only log a warning for each of them
+		Population.RoomType = RoomTypesDataTable && !RoomTypeRowName.IsNone() ? RoomTypesDataTable->FindRow<FRoomType>(RoomTypeRowName, ContextString) : nullptr;
+		Population.Seed = Stream.RandHelper(MAX_int32);
+	}
+
+	ParallelFor(Rooms.Num(), [this](int32 RoomIndex)
+	{
+		PopulateRoom(Rooms[RoomIndex], RoomPopulations[RoomIndex]);
+	});
+
+	// A component needs to know how much custom data its instances have before the first prop is added.
+	// Room templates may already have added instances to the same component, SetNumCustomDataFloats resizes their custom data too
+	for (const FRoomPopulation& Population : RoomPopulations)
+	{
+		for (int32 PointIndex = 0; PointIndex < Population.MeshIndexes.Num(); PointIndex++)
+		{
+			int32 ScatterIndex = Algo::UpperBound(Population.ScatterStarts, PointIndex) - 1;
+			const FRandomTile& Prop = Population.RoomType->PropScatters[ScatterIndex].PropMeshes[Population.MeshIndexes[PointIndex]];
+
+			UInstancedStaticMeshComponent* Component = GetPropComponent(Prop.Mesh);
+
+			if (Component && Prop.CustomData.Num() > Component->NumCustomDataFloats)
+			{
+				Component->SetNumCustomDataFloats(Prop.CustomData.Num());
+			}
+		}
+	}
+
+	// Props aren't lined up with the tiles so they go straight to their components rather than through the tile culling
+	const FTransform& ActorTransform = GetActorTransform();
+	int32 NumProps = 0;
+
+	for (const FRoomPopulation& Population : RoomPopulations)
+	{
+		RoomSpawnPointStarts.Add(SpawnPoints.Num());
+
+		for (int32 PointIndex = 0; PointIndex < Population.Points.Num(); PointIndex++)
+		{
+			FVector Location(Population.Points[PointIndex] * TileSize, 0.f);
+
+			if (PointIndex >= Population.MeshIndexes.Num())
+			{
+				SpawnPoints.Add(ActorTransform.TransformPosition(Location));
+				continue;
+			}
+
+			int32 ScatterIndex = Algo::UpperBound(Population.ScatterStarts, PointIndex) - 1;
+			const FRandomTile& Prop = Population.RoomType->PropScatters[ScatterIndex].PropMeshes[Population.MeshIndexes[PointIndex]];
+			UInstancedStaticMeshComponent* Component = GetPropComponent(Prop.Mesh);
+
+			if (!Component)
+			{
+				continue;
+			}
+
+			int32 InstanceIndex = Component->AddInstance(FTransform(FRotator(0.f, Population.Yaws[PointIndex], 0.f), Location));
+
+			for (int32 i = 0; i < Prop.CustomData.Num(); i++)
+			{
+				Component->SetCustomDataValue(InstanceIndex, i, Prop.CustomData[i], false);
+			}
+
+			NumProps++;
+		}
+	}
+
+	RoomSpawnPointStarts.Add(SpawnPoints.Num());
+
+	UE_LOG(LogDungeonGenerator, Log, TEXT("Scattered %d props and %d spawn points over %d rooms"), NumProps, SpawnPoints.Num(), Rooms.Num());
+}
+
+void ADungeonGenerator::PopulateRoom(URoom* Room, FRoomPopulation& Population)
+{
+	Population.Points.Reset();
+	Population.ScatterStarts.Reset();
+	Population.MeshIndexes.Reset();
+	Population.Yaws.Reset();
+
+	if (!Population.RoomType)
+	{
+		return;
+	}
+
+	FRandomStream RoomStream(Population.Seed);
+	FIntRect RoomRect = Room->GetRoomRect();
+
+	// Keep the floor tile inside each door clear so nothing blocks the way in
+	TArray<FBox2D, TInlineAllocator<8>> DoorAreas;
+
+	for (const FIntPoint& DoorPivot : Room->DoorLocations)
+	{
+		for (uint8 Side = 0; Side < 4; Side++)
+		{
+			EDungeonDirection Direction = static_cast<EDungeonDirection>(Side);
+			FIntPoint Cell = DoorPivot - FDungeonTileGrid::GetWallPivot(FIntPoint::ZeroValue, Direction);
+
+			if (RoomRect.Contains(Cell) && !RoomRect.Contains(FDungeonTileGrid::GetNeighbour(Cell, Direction)))
+			{
+				DoorAreas.Add(FBox2D(FVector2D(Cell), FVector2D(Cell + FIntPoint(1, 1))));
+			}
+		}
+	}
+
+	auto GetScatterArea = [&RoomRect](const FRoomScatter& Scatter)
+	{
+		return FBox2D(FVector2D(RoomRect.Min) + Scatter.WallClearance, FVector2D(RoomRect.Max) - Scatter.WallClearance);
+	};
+
+	for (const FRoomPropScatter& Scatter : Population.RoomType->PropScatters)
+	{
+		int32 FirstPoint = Population.Points.Num();
+		Population.ScatterStarts.Add(FirstPoint);
+
+		if (Scatter.PropMeshes.Num() == 0)
+		{
+			continue;
+		}
+
+		FPoissonDiskSampler::Sample(GetScatterArea(Scatter), Scatter.MinDistance, Scatter.MaxPoints, DoorAreas, RoomStream, Population.Points);
+
+		for (int32 PointIndex = FirstPoint; PointIndex < Population.Points.Num(); PointIndex++)
+		{
+			Population.MeshIndexes.Add(PickRandomTileIndex(Scatter.PropMeshes, RoomStream));
+			Population.Yaws.Add(Scatter.bRandomYaw ? RoomStream.FRandRange(0.f, 360.f) : 0.f);
+		}
+	}
+
+	Population.ScatterStarts.Add(Population.Points.Num());
+
+	const FRoomScatter& SpawnPointScatter = Population.RoomType->SpawnPointScatter;
+	FPoissonDiskSampler::Sample(GetScatterArea(SpawnPointScatter), SpawnPointScatter.MinDistance, SpawnPointScatter.MaxPoints, DoorAreas, RoomStream, Population.Points);
+}
+
+UInstancedStaticMeshComponent* ADungeonGenerator::GetPropComponent(UStaticMesh* Mesh)
+{
+	if (!Mesh)
+	{
+		return nullptr;
+	}
+
+	if (UInstancedStaticMeshComponent** Component = PropComponents.Find(Mesh))
+	{
+		return *Component;
+	}
+
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(this);
+	Component->SetCanEverAffectNavigation(bTilesAffectNavigation);
+
+	// The component spans the whole dungeon so the props are culled one by one rather than with a room's proxy
+	if (bUseRoomProxies)
+	{
+		Component->InstanceEndCullDistance = FMath::RoundToInt(RoomProxyDistance);
+	}
+
+	Component->RegisterComponent();
+	Component->SetStaticMesh(Mesh);
+	Component->AttachTo(GetRootComponent());
+
+	TileComponents.Add(Component);
+	PropComponents.Add(Mesh, Component);
+
+	return Component;
+}
+
+void ADungeonGenerator::SpawnRoomWalls(URoom* &Room)
+{
+	FRotator WallRotation = FRotator(0.f);
+
+	// Spawn wall tiles along bottom wall
+	FIntPoint StartPoint = Room->Position;
+	FIntPoint EndPoint = Room->Position + FIntPoint(0, Room->Size.Y);
+	SpawnWall(StartPoint, EndPoint, WallRotation, Room->WallHeight, Room->DoorLocations);
+
+	// Spawn wall tiles along top wall
+	WallRotation = FRotator(0.f, 180.f, 0.f);
+	StartPoint = Room->Position + Room->Size;
+	EndPoint = Room->Position + FIntPoint(Room->Size.X, 0);
+	SpawnWall(StartPoint, EndPoint, WallRotation, Room->WallHeight, Room->DoorLocations);
+
+	// Spawn wall tiles along left wall
+	WallRotation = FRotator(0.f, 90.f, 0.f);
+	StartPoint = Room->Position + FIntPoint(Room->Size.X, 0);
+	EndPoint = Room->Position;
+	SpawnWall(StartPoint, EndPoint, WallRotation, Room->WallHeight, Room->DoorLocations);
+
+	// Spawn wall tiles along right wall
+	WallRotation = FRotator(0.f, -90.f, 0.f);
+	StartPoint = Room->Position + FIntPoint(0, Room->Size.Y);
+	EndPoint = Room->GetRoomMax();
+	SpawnWall(StartPoint, EndPoint, WallRotation, Room->WallHeight ,Room->DoorLocations);
+}
+
+void ADungeonGenerator::SpawnWall(FIntPoint &StartPoint, FIntPoint &EndPoint, FRotator &Rotation, const int32 &Height, const TArray<FIntPoint>& DoorLocations)
+{
+	// Walls only run along one axis so only one of the two differences isn't zero
+	int32 WallLength = FMath::Abs(EndPoint.X - StartPoint.X) + FMath::Abs(EndPoint.Y - StartPoint.Y);
+	bool SpawnAlongX = StartPoint.X != EndPoint.X;
+	bool Subract = false;
+
+	// Check if we are placing tiles forward or backward
+	if (SpawnAlongX)
+		Subract = StartPoint.X > EndPoint.X;
+	else
+		Subract = StartPoint.Y > EndPoint.Y;
+
+	for (int32 i = 0; i < WallLength; i++)
+	{
+		int32 X = StartPoint.X;
+		int32 Y = StartPoint.Y;
+
+		if (SpawnAlongX)
+			Subract ? X -= i : X += i;
+		else
+			Subract ? Y -= i : Y += i;
+
+		// Doors only replace the bottom tile of the wall
+		bool bIsDoor = DoorLocations.Contains(FIntPoint(X, Y));
+
+		for (int32 h = 0; h < Height; h++)
+		{
+			FVector Location = FVector(X, Y, h) * TileSize;
+
+			const TArray<FRandomTile>* WallTilesToSpawn = &RoomWallTiles;
+			const TArray<FRandomTile>* WallAdditionTilesToSpawn = &RoomWallAdditionTiles;
+
+			// Check if the current location should be a door
+			if (bIsDoor && h == 0)
+			{		
+				WallTilesToSpawn = &RoomDoorTiles;
+				WallAdditionTilesToSpawn = &RoomDoorAdditionTiles;
+			}
+
+			// Spawn wall tile
+			SpawnRandomTile(*WallTilesToSpawn, FTransform(Rotation, Location));
+
+			// Spawn wall addition tile
+			SpawnAllTiles(*WallAdditionTilesToSpawn, FTransform(Rotation, Location), h);
+		}
+	}
+}
+
+void ADungeonGenerator::CreateInstancedStaticMeshComponents(const TArray<FRandomTile>& TileMeshes, TArray<FRandomTile>& InstancedTileMeshes)
+{
+	// Overwrite the previously used meshes in place so their custom data arrays are reused rather than reallocated
+	InstancedTileMeshes.SetNum(TileMeshes.Num(), false);
+
+	if (TileMeshes.Num() > 0)
+	{
+		for (int32 TileIndex = 0; TileIndex < TileMeshes.Num(); TileIndex++)
+		{
+			const FRandomTile& Tile = TileMeshes[TileIndex];
+			UInstancedStaticMeshComponent* Instance = nullptr;
+
+			// Reuse the component of an earlier variant with the same mesh, the variant's custom data tells them apart
+			if (bShareVariantComponents)
+			{
+				for (int32 i = 0; i < TileIndex; i++)
+				{
+					if (InstancedTileMeshes[i].Mesh == Tile.Mesh)
+					{
+						Instance = InstancedTileMeshes[i].InstancedMeshComponent;
+						break;
+					}
+				}
+			}
+
+			if (!Instance)
+			{
+				Instance = NewObject<UInstancedStaticMeshComponent>(this);
+				Instance->SetCanEverAffectNavigation(bTilesAffectNavigation);
+
+				// The simplified collision stands in for the tiles so they don't need a physics body each
+				if (bUseSimplifiedCollision)
+				{
+					Instance->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+				}
+
+				// Room tiles are only drawn up close, their proxy is drawn instead further away
+				if (CurrentRoomProxy)
+				{
+					Instance->bUseAttachParentBound = true;
+					Instance->LDMaxDrawDistance = RoomProxyDistance;
+				}
+
+				Instance->RegisterComponent();
+				Instance->SetStaticMesh(Tile.Mesh);
+				Instance->AttachTo(CurrentRoomProxy ? CurrentRoomProxy : GetRootComponent());
+
+				TileComponents.Add(Instance);
+			}
+
+			// Resizes the custom data of any instances the shared component already has
+			if (Tile.CustomData.Num() > Instance->NumCustomDataFloats)
+			{
+				Instance->SetNumCustomDataFloats(Tile.CustomData.Num());
+			}
+
+			InstancedTileMeshes[TileIndex] = Tile;
+			InstancedTileMeshes[TileIndex].InstancedMeshComponent = Instance;
+		}
+	}
+}
+
+void ADungeonGenerator::SpawnCorridorTiles()
+{	
+	for (int32 Index = 0; Index < Layout->TileGrid.Num(); Index++)
+	{
+		const FDungeonTile& Tile = Layout->TileGrid.Tiles[Index];
+
+		if (Tile.Type != EDungeonTileType::Corridor)
+		{
+			continue;
+		}
+
+		FIntPoint Cell = Layout->TileGrid.ToCell(Index);
+		FVector PositionOfTile = FVector(Cell.X, Cell.Y, 0.f) * TileSize;
+
+		SpawnRandomTile(CorridorFloorTiles, FTransform(PositionOfTile));
+
+		// Spawn walls along every side that doesn't lead into more corridor or through a door
+		for (uint8 Side = 0; Side < 4; Side++)
+		{
+			EDungeonDirection Direction = static_cast<EDungeonDirection>(Side);
+
+			if ((Tile.DoorMask & (1 << Side)) || Layout->TileGrid.GetTileType(FDungeonTileGrid::GetNeighbour(Cell, Direction)) == EDungeonTileType::Corridor)
+			{
+				continue;
+			}
+
+			FIntPoint WallPivot = FDungeonTileGrid::GetWallPivot(Cell, Direction);
+			SpawnRandomTile(CorridorWallTiles, FTransform(FDungeonTileGrid::GetWallRotation(Direction), FVector(WallPivot.X, WallPivot.Y, 0.f) * TileSize));
+		}
+
+		SpawnRandomTile(CorridorCeilingTiles, FTransform(PositionOfTile + FVector(0.f, 0.f, TileSize)));
+	}
+}
+
+void ADungeonGenerator::QueueTileInstance(const FRandomTile& Tile, const FTransform& AtLocation)
+{
+	PendingTileInstances.Add({ Tile.InstancedMeshComponent, AtLocation, PendingCustomData.Num(), Tile.CustomData.Num() });
+	PendingCustomData.Append(Tile.CustomData);
+}
+
+void ADungeonGenerator::SpawnRandomTile(const TArray<FRandomTile> &InstancedTileMeshesArray, const FTransform &AtLocation)
+{
+	int32 TileToSpawnIndex = PickRandomTileIndex(InstancedTileMeshesArray, Stream);
+
+	if (TileToSpawnIndex != INDEX_NONE)
+	{
+		QueueTileInstance(InstancedTileMeshesArray[TileToSpawnIndex], AtLocation);
+	}
+}
+
+void ADungeonGenerator::SpawnAllTiles(const TArray<FRandomTile>& InstancedTileMeshesArray, const FTransform& AtLocation, const int32 CurrentHeight)
+{
+	if (InstancedTileMeshesArray.Num() > 0)
+	{
+		for (const FRandomTile& Tile : InstancedTileMeshesArray)
+		{
+			QueueTileInstance(Tile, AtLocation);
+		}
+	}
+}
+
+void ADungeonGenerator::SubmitTileInstances()
+{
+	NumCulledInstances = 0;
+
+	if (!bCullTileInstances)
+	{
+		for (const FPendingTileInstance& Instance : PendingTileInstances)
+		{
+			AddPendingTileInstance(Instance);
+		}
+
+		FinishSubmittingTileInstances();
+		return;
+	}
+
+	// Two instances of the same mesh in the same place, only one of them can ever be seen. These come from tile sets that list
+	// a mesh more than once, such as a wall mesh that is also one of the wall additions.
+	// Sorting the keys puts them next to each other, the earliest one queued is kept so the result doesn't depend on the sort
+	PendingTileKeys.Reset(PendingTileInstances.Num());
+
+	for (int32 Index = 0; Index < PendingTileInstances.Num(); Index++)
+	{
+		const FPendingTileInstance& Instance = PendingTileInstances[Index];
+		FVector Location = Instance.Transform.GetLocation();
+		int32 Quarter = FMath::RoundToInt(FRotator::NormalizeAxis(Instance.Transform.Rotator().Yaw) / 90.f);
+
+		FTileInstanceKey Key = { Instance.InstancedMeshComponent->GetStaticMesh(), FIntVector(FMath::RoundToInt(Location.X), FMath::RoundToInt(Location.Y), FMath::RoundToInt(Location.Z)), (Quarter + 4) % 4, Index };
+		PendingTileKeys.Add(Key);
+	}
+
+	PendingTileKeys.Sort([](const FTileInstanceKey& A, const FTileInstanceKey& B)
+	{
+		if (A.Mesh != B.Mesh)
+			return A.Mesh < B.Mesh;
+		if (A.Location.X != B.Location.X)
+			return A.Location.X < B.Location.X;
+		if (A.Location.Y != B.Location.Y)
+			return A.Location.Y < B.Location.Y;
+		if (A.Location.Z != B.Location.Z)
+			return A.Location.Z < B.Location.Z;
+		if (A.Quarter != B.Quarter)
+			return A.Quarter < B.Quarter;
+
+		return A.Index < B.Index;
+	});
+
+	// Reset rather than Init so the buffers are only reallocated when they need to grow
+	IsDuplicateTile.Reset();
+	IsDuplicateTile.SetNumZeroed(PendingTileInstances.Num());
+
+	for (int32 i = 1; i < PendingTileKeys.Num(); i++)
+	{
+		IsDuplicateTile[PendingTileKeys[i].Index] = PendingTileKeys[i].IsSameInstance(PendingTileKeys[i - 1]);
+	}
+
+	for (int32 Index = 0; Index < PendingTileInstances.Num(); Index++)
+	{
+		if (IsDuplicateTile[Index])
+		{
+			NumCulledInstances++;
+			continue;
+		}
+
+		AddPendingTileInstance(PendingTileInstances[Index]);
+	}
+
+	UE_LOG(LogDungeonGenerator, Log, TEXT("Culled %d duplicate tile instances of %d"), NumCulledInstances, PendingTileInstances.Num());
+
+	FinishSubmittingTileInstances();
+}
+
+void ADungeonGenerator::FinishSubmittingTileInstances()
+{
+	// The custom data was set without updating the render state so only do it once per component
+	for (UInstancedStaticMeshComponent* Component : TileComponents)
+	{
+		if (Component->NumCustomDataFloats > 0)
+		{
+			Component->MarkRenderStateDirty();
+		}
+	}
+
+	PendingTileInstances.Reset();
+	PendingCustomData.Reset();
+}
+
+void ADungeonGenerator::AddPendingTileInstance(const FPendingTileInstance& Instance)
+{
+	int32 InstanceIndex = Instance.InstancedMeshComponent->AddInstance(Instance.Transform);
+
+	for (int32 i = 0; i < Instance.NumCustomData; i++)
+	{
+		Instance.InstancedMeshComponent->SetCustomDataValue(InstanceIndex, i, PendingCustomData[Instance.CustomDataOffset + i], false);
+	}
+}
+
+void ADungeonGenerator::SpawnSimplifiedCollision()
+{
+	// One floor box per room, template meshes keep their own collision so template rooms get none
+	for (URoom* Room : Rooms)
+	{
+		if (!Room->bHasTiles)
+		{
+			continue;
+		}
+
+		FIntRect RoomRect = Room->GetRoomRect();
+		AddCollisionBox(FVector(RoomRect.Min.X * TileSize, RoomRect.Min.Y * TileSize, -CollisionThickness), FVector(RoomRect.Max.X * TileSize, RoomRect.Max.Y * TileSize, 0.f));
+	}
+
+	// Merge the corridor tiles into rectangles, grow along the Y first then along the X while the whole run is corridor
+	TDungeonScratchArray<bool> Covered;
+	Covered.Init(false, Layout->TileGrid.Num());
+
+	auto IsUncoveredCorridor = [this, &Covered](const FIntPoint& Tile)
+	{
+		return Layout->TileGrid.GetTileType(Tile) == EDungeonTileType::Corridor && !Covered[Layout->TileGrid.ToIndex(Tile)];
+	};
+
+	for (int32 Index = 0; Index < Layout->TileGrid.Num(); Index++)
+	{
+		FIntPoint Start = Layout->TileGrid.ToCell(Index);
+
+		if (!IsUncoveredCorridor(Start))
+		{
+			continue;
+		}
+
+		FIntPoint End = Start;
+		while (IsUncoveredCorridor(End + FIntPoint(0, 1)))
+		{
+			End.Y++;
+		}
+
+		bool CanGrow = true;
+		while (CanGrow)
+		{
+			for (int32 y = Start.Y; y <= End.Y && CanGrow; y++)
+			{
+				CanGrow = IsUncoveredCorridor(FIntPoint(End.X + 1, y));
+			}
+
+			if (CanGrow)
+			{
+				End.X++;
+			}
+		}
+
+		for (int32 x = Start.X; x <= End.X; x++)
+		{
+			for (int32 y = Start.Y; y <= End.Y; y++)
+			{
+				Covered[Layout->TileGrid.ToIndex(FIntPoint(x, y))] = true;
+			}
+		}
+
+		AddCollisionBox(FVector(Start.X * TileSize, Start.Y * TileSize, -CollisionThickness), FVector((End.X + 1) * TileSize, (End.Y + 1) * TileSize, 0.f));
+	}
+
+	// Merge neighbouring wall edges of the same height into one box, walls on the top and bottom of tiles run along the Y
+	for (EDungeonDirection Side : { EDungeonDirection::Top, EDungeonDirection::Bottom, EDungeonDirection::Right, EDungeonDirection::Left })
+	{
+		bool RunsAlongY = Side == EDungeonDirection::Top || Side == EDungeonDirection::Bottom;
+		int32 NumLines = RunsAlongY ? Layout->TileGrid.Width : Layout->TileGrid.Height;
+		int32 LineLength = RunsAlongY ? Layout->TileGrid.Height : Layout->TileGrid.Width;
+
+		// Walls on the far side of a tile are on the line after it
+		int32 LineOffset = (Side == EDungeonDirection::Top || Side == EDungeonDirection::Right) ? 1 : 0;
+
+		for (int32 Line = 0; Line < NumLines; Line++)
+		{
+			int32 RunStart = INDEX_NONE;
+			int32 RunMinHeight = 0;
+			int32 RunMaxHeight = 0;
+
+			for (int32 Along = 0; Along <= LineLength; Along++)
+			{
+				int32 MinHeight = 0;
+				int32 MaxHeight = 0;
+				bool HasWall = false;
+
+				if (Along < LineLength)
+				{
+					FIntPoint Tile = Layout->TileGrid.Origin + (RunsAlongY ? FIntPoint(Line, Along) : FIntPoint(Along, Line));
+					HasWall = GetWallCollision(Tile, Side, MinHeight, MaxHeight);
+				}
+
+				bool ContinuesRun = HasWall && RunStart != INDEX_NONE && MinHeight == RunMinHeight && MaxHeight == RunMaxHeight;
+
+				if (RunStart != INDEX_NONE && !ContinuesRun)
+				{
+					// Finish the current run
+					float LinePosition = (RunsAlongY ? Layout->TileGrid.Origin.X : Layout->TileGrid.Origin.Y) + Line + LineOffset;
+					float RunMin = (RunsAlongY ? Layout->TileGrid.Origin.Y : Layout->TileGrid.Origin.X) + RunStart;
+					float RunMax = (RunsAlongY ? Layout->TileGrid.Origin.Y : Layout->TileGrid.Origin.X) + Along;
+
+					FVector Min = RunsAlongY ? FVector(LinePosition * TileSize - CollisionThickness / 2, RunMin * TileSize, RunMinHeight * TileSize)
+						: FVector(RunMin * TileSize, LinePosition * TileSize - CollisionThickness / 2, RunMinHeight * TileSize);
+					FVector Max = RunsAlongY ? FVector(LinePosition * TileSize + CollisionThickness / 2, RunMax * TileSize, RunMaxHeight * TileSize)
+						: FVector(RunMax * TileSize, LinePosition * TileSize + CollisionThickness / 2, RunMaxHeight * TileSize);
+
+					AddCollisionBox(Min, Max);
+					RunStart = INDEX_NONE;
+				}
+
+				if (HasWall && RunStart == INDEX_NONE)
+				{
+					RunStart = Along;
+					RunMinHeight = MinHeight;
+					RunMaxHeight = MaxHeight;
+				}
+			}
+		}
+	}
+
+	UE_LOG(LogDungeonGenerator, Log, TEXT("Created %d collision boxes"), CollisionComponents.Num());
+}
+
+bool ADungeonGenerator::GetWallCollision(const FIntPoint& Tile, EDungeonDirection Side, int32& OutMinHeight, int32& OutMaxHeight)
+{
+	if (!Layout->TileGrid.IsInside(Tile))
+	{
+		return false;
+	}
+
+	const FDungeonTile& CurrentTile = Layout->TileGrid.GetTile(Tile);
+	FIntPoint Neighbour = FDungeonTileGrid::GetNeighbour(Tile, Side);
+	EDungeonTileType NeighbourType = Layout->TileGrid.GetTileType(Neighbour);
+
+	switch (CurrentTile.Type)
+	{
+	case EDungeonTileType::Room:
+	{
+		if (NeighbourType == EDungeonTileType::Room)
+		{
+			return false;
+		}
+
+		URoom* Room = Rooms[CurrentTile.RoomIndex];
+
+		if (!Room->bHasTiles)
+		{
+			return false;
+		}
+
+		FIntPoint WallPivot = FDungeonTileGrid::GetWallPivot(Tile, Side);
+
+		// Doors only leave the bottom tile open
+		OutMinHeight = Room->DoorLocations.Contains(WallPivot) ? 1 : 0;
+		OutMaxHeight = Room->WallHeight;
+
+		return OutMaxHeight > OutMinHeight;
+	}
+	case EDungeonTileType::Corridor:
+	{
+		// Walls shared with a room are covered by the room's box
+		if (NeighbourType != EDungeonTileType::Empty || (CurrentTile.DoorMask & (1 << static_cast<uint8>(Side))))
+		{
+			return false;
+		}
+
+		OutMinHeight = 0;
+		OutMaxHeight = 1;
+
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+void ADungeonGenerator::AddCollisionBox(const FVector& Min, const FVector& Max)
+{
+	UBoxComponent* CollisionBox = NewObject<UBoxComponent>(this);
+	CollisionBox->SetCollisionProfileName(CollisionProfileName);
+	CollisionBox->SetCanEverAffectNavigation(bTilesAffectNavigation);
+	CollisionBox->SetBoxExtent((Max - Min) / 2, false);
+	CollisionBox->SetupAttachment(GetRootComponent());
+	CollisionBox->SetRelativeLocation((Min + Max) / 2);
+	CollisionBox->RegisterComponent();
+
+	CollisionComponents.Add(CollisionBox);
+}
+
+FRoomType* ADungeonGenerator::PickRandomRoomTypeForRoom(URoom*& CurrentRoom)
+{
+	FRoomType* SelectedRoomType = nullptr;
+
+	if (RoomTypesDataTable)
+	{
+		bool RoomSelected = false;
+		FName RoomTypeRowName;
+
+		// Templates only fit some rooms, make sure something fits before picking
+		bool bAnyRoomTypeFits = RoomTypeRows.ContainsByPredicate([this, CurrentRoom](const FRoomType* RoomType)
+		{
+			return CanUseRoomType(CurrentRoom->GetRoomRect(), CurrentRoom->DoorLocations, *RoomType);
+		});
+
+		if (!bAnyRoomTypeFits)
+		{
+			UE_LOG(LogDungeonGenerator, Warning, TEXT("No room type fits room %d, every room type has a template of a different size or door layout"), CurrentRoom->Index);
+			return nullptr;
+		}
+
+		// Randomly select a room from the datatable using it's probability
+		while (!RoomSelected)
+		{
+			int32 RoomIndex = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, RoomTypeRowNames.Num() - 1, Stream);
+			RoomTypeRowName = RoomTypeRowNames[RoomIndex];
+			SelectedRoomType = RoomTypeRows[RoomIndex];
+			float Probability = SelectedRoomType->Probability == 0 ? 1 : SelectedRoomType->Probability;
+
+			RoomSelected = UKismetMathLibrary::RandomBoolWithWeightFromStream(Probability, Stream) && CanUseRoomType(CurrentRoom->GetRoomRect(), CurrentRoom->DoorLocations, *SelectedRoomType);
+		}
+
+		CurrentRoom->SetWallHeight(SelectedRoomType->WallHeight);
+		CurrentRoom->RoomTypeRowName = RoomTypeRowName;
+	}
+
+	return SelectedRoomType;
+}
+
+bool ADungeonGenerator::CanUseRoomType(const FIntRect& RoomRect, TArrayView<const FIntPoint> DoorLocations, const FRoomType& RoomType)
+{
+	if (!RoomType.Template)
+	{
+		return true;
+	}
+
+	TArray<FIntPoint, TInlineAllocator<8>> RelativeDoorLocations;
+
+	for (const FIntPoint& DoorLocation : DoorLocations)
+	{
+		RelativeDoorLocations.Add(DoorLocation - RoomRect.Min);
+	}
+
+	return RoomType.Template->CanBeUsedFor(RoomRect.Size(), RelativeDoorLocations);
+}
+
+void ADungeonGenerator::StampRoomTemplate(URoom* Room, const URoomTemplate* Template)
+{
+	FVector RoomLocation = FVector(Room->Position.X, Room->Position.Y, 0.f) * TileSize;
+
+	for (const FRoomTemplateMesh& TemplateMesh : Template->Meshes)
+	{
+		UInstancedStaticMeshComponent* Component = GetPropComponent(TemplateMesh.Mesh);
+
+		if (!Component || TemplateMesh.Transforms.Num() == 0)
+		{
+			continue;
+		}
+
+		// Copy the whole list in one go, moving each instance to the room is the only work done per instance
+		TemplateTransforms.Reset();
+		TemplateTransforms.Append(TemplateMesh.Transforms);
+
+		for (FTransform& Transform : TemplateTransforms)
+		{
+			Transform.AddToTranslation(RoomLocation);
+		}
+
+		Component->AddInstances(TemplateTransforms, false);
+	}
+}
+
+void ADungeonGenerator::CreateInstancedStaticMeshesForCurrentRoom(FRoomType* &SelectedRoomType)
+{
+	if (SelectedRoomType)
+	{
+		// Create instanced static meshes of the meshes selected in the row
+		CreateInstancedStaticMeshComponents(SelectedRoomType->FloorTileMeshes, RoomFloorTiles);
+		CreateInstancedStaticMeshComponents(SelectedRoomType->WallTileMeshes, RoomWallTiles);
+		CreateInstancedStaticMeshComponents(SelectedRoomType->CeilingTileMeshes, RoomCeilingTiles);
+		CreateInstancedStaticMeshComponents(SelectedRoomType->DoorTileMeshes, RoomDoorTiles);
+		CreateInstancedStaticMeshComponents(SelectedRoomType->WallAdditionTileMeshes, RoomWallAdditionTiles);
+		CreateInstancedStaticMeshComponents(SelectedRoomType->DoorAdditionTileMeshes, RoomDoorAdditionTiles);
+	}
+}
+
+int32 ADungeonGenerator::CreateRoomProxy(URoom* Room, const FRoomType* RoomType)
+{
+	if (Room->WallHeight <= 0)
+	{
+		return 0;
+	}
+
+	for (FRoomProxySection& Section : RoomProxySections)
+	{
+		Section.Reset();
+	}
+
+	FRoomProxySection& Floor = RoomProxySections[0];
+	FRoomProxySection& Walls = RoomProxySections[1];
+	FRoomProxySection& Ceiling = RoomProxySections[2];
+
+	FIntRect RoomRect = Room->GetRoomRect();
+	FVector RoomMin(RoomRect.Min.X * TileSize, RoomRect.Min.Y * TileSize, 0.f);
+	FVector RoomSize(RoomRect.Width() * TileSize, RoomRect.Height() * TileSize, Room->WallHeight * TileSize);
+
+	Floor.AddQuad(RoomMin, FVector(RoomSize.X, 0.f, 0.f), FVector(0.f, RoomSize.Y, 0.f), FVector::UpVector, TileSize);
+	Ceiling.AddQuad(RoomMin + FVector(0.f, 0.f, RoomSize.Z), FVector(RoomSize.X, 0.f, 0.f), FVector(0.f, RoomSize.Y, 0.f), FVector::DownVector, TileSize);
+
+	for (uint8 Side = 0; Side < 4; Side++)
+	{
+		EDungeonDirection Direction = static_cast<EDungeonDirection>(Side);
+		FIntPoint Outward = FDungeonTileGrid::GetNeighbour(FIntPoint::ZeroValue, Direction);
+
+		// Walk along the row of room tiles on this side
+		FIntPoint Step = Outward.X != 0 ? FIntPoint(0, 1) : FIntPoint(1, 0);
+		FIntPoint FirstTile(Outward.X > 0 ? RoomRect.Max.X - 1 : RoomRect.Min.X, Outward.Y > 0 ? RoomRect.Max.Y - 1 : RoomRect.Min.Y);
+		int32 Length = Outward.X != 0 ? RoomRect.Height() : RoomRect.Width();
+
+		auto AddWallRun = [&](int32 RunStart, int32 RunEnd, int32 BottomHeight, int32 TopHeight)
+		{
+			FIntPoint Tile = FirstTile + Step * RunStart;
+			FVector Corner((Tile.X + (Outward.X > 0 ? 1 : 0)) * TileSize, (Tile.Y + (Outward.Y > 0 ? 1 : 0)) * TileSize, BottomHeight * TileSize);
+			FVector AxisU = FVector(Step.X, Step.Y, 0.f) * (RunEnd - RunStart) * TileSize;
+			FVector AxisV(0.f, 0.f, (TopHeight - BottomHeight) * TileSize);
+
+			Walls.AddQuad(Corner, AxisU, AxisV, -FVector(Outward.X, Outward.Y, 0.f), TileSize);
+		};
+
+		// Doors are only on the bottom row, so the wall above them is one quad and the bottom row is split either side of the doors
+		if (Room->WallHeight > 1)
+		{
+			AddWallRun(0, Length, 1, Room->WallHeight);
+		}
+
+		int32 RunStart = 0;
+
+		for (int32 i = 0; i <= Length; i++)
+		{
+			bool bIsDoor = false;
+
+			if (i < Length)
+			{
+				FIntPoint DoorPivot = FDungeonTileGrid::GetWallPivot(FirstTile + Step * i, Direction);
+				bIsDoor = Room->DoorLocations.Contains(DoorPivot);
+			}
+
+			if (i == Length || bIsDoor)
+			{
+				if (i > RunStart)
+				{
+					AddWallRun(RunStart, i, 0, 1);
+				}
+
+				RunStart = i + 1;
+			}
+		}
+	}
+
+	UProceduralMeshComponent* Proxy = NewObject<UProceduralMeshComponent>(this);
+	Proxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Proxy->SetCanEverAffectNavigation(false);
+	Proxy->MinDrawDistance = RoomProxyDistance;
+	Proxy->RegisterComponent();
+	Proxy->AttachTo(GetRootComponent());
+
+	const TArray<FRandomTile>* SectionTiles[] = { &RoomType->FloorTileMeshes, &RoomType->WallTileMeshes, &RoomType->CeilingTileMeshes };
+	int32 NumTriangles = 0;
+
+	for (int32 SectionIndex = 0; SectionIndex < UE_ARRAY_COUNT(RoomProxySections); SectionIndex++)
+	{
+		const FRoomProxySection& Section = RoomProxySections[SectionIndex];
+
+		if (Section.Vertices.Num() == 0)
+		{
+			continue;
+		}
+
+		Proxy->CreateMeshSection(SectionIndex, Section.Vertices, Section.Triangles, Section.Normals, Section.UVs, TArray<FColor>(), TArray<FProcMeshTangent>(), false);
+
+		const TArray<FRandomTile>& Tiles = *SectionTiles[SectionIndex];
+
+		if (Tiles.Num() > 0 && Tiles[0].Mesh)
+		{
+			Proxy->SetMaterial(SectionIndex, Tiles[0].Mesh->GetMaterial(0));
+		}
+
+		NumTriangles += Section.Triangles.Num() / 3;
+	}
+
+	RoomProxyComponents.Add(Proxy);
+	CurrentRoomProxy = Proxy;
+
+	return NumTriangles;
+}
+
+void FRoomProxySection::Reset()
+{
+	Vertices.Reset();
+	Triangles.Reset();
+	Normals.Reset();
+	UVs.Reset();
+}
+
+void FRoomProxySection::AddQuad(const FVector& Corner, const FVector& AxisU, const FVector& AxisV, const FVector& Normal, float TileSize)
+{
+	int32 FirstVertex = Vertices.Num();
+
+	Vertices.Add(Corner);
+	Vertices.Add(Corner + AxisU);
+	Vertices.Add(Corner + AxisU + AxisV);
+	Vertices.Add(Corner + AxisV);
+
+	float U = AxisU.Size() / TileSize;
+	float V = AxisV.Size() / TileSize;
+
+	UVs.Add(FVector2D(0.f, 0.f));
+	UVs.Add(FVector2D(U, 0.f));
+	UVs.Add(FVector2D(U, V));
+	UVs.Add(FVector2D(0.f, V));
+
+	for (int32 i = 0; i < 4; i++)
+	{
+		Normals.Add(Normal);
+	}
+
+	// The procedural mesh faces a triangle along (P1 - P2) ^ (P0 - P2), which for the first triangle is AxisV ^ AxisU
+	bool bFlip = ((AxisV ^ AxisU) | Normal) < 0.f;
+
+	Triangles.Add(FirstVertex);
+	Triangles.Add(FirstVertex + (bFlip ? 2 : 1));
+	Triangles.Add(FirstVertex + (bFlip ? 1 : 2));
+	Triangles.Add(FirstVertex);
+	Triangles.Add(FirstVertex + (bFlip ? 3 : 2));
+	Triangles.Add(FirstVertex + (bFlip ? 2 : 3));
+}
+
+void ADungeonGenerator::SpawnLightsInRooms()
+{
+	if(RoomTypesDataTable)
+	{
+		static const FString ContextString(TEXT("Selected Room Context"));
+
+		for (URoom* Room : Rooms)
+		{
+			// Rooms that no room type fits don't have a row
+			if (Room->RoomTypeRowName.IsNone())
+			{
+				continue;
+			}
+
+			FRoomType* RoomType = RoomTypesDataTable->FindRow<FRoomType>(Room->RoomTypeRowName, ContextString);
+
+			if (RoomType && RoomType->LightActors.Num())
+			{
+				for (const FLightSource& LightActor : RoomType->LightActors)
+				{
+					FActorSpawnParameters SpawnParams;
+					int32 GapBetweenLights = LightActor.TileDistanceBetweenNext == 0 ? 1 : LightActor.TileDistanceBetweenNext;
+
+					switch (LightActor.Location)
+					{
+					case EObjectLocation::EOL_AroundRoom:
+					{
+						FIntPoint RoomMin = Room->Position;
+						FIntPoint RoomMax = Room->GetRoomMax();
+						FVector StartLocation = FVector(RoomMin.X, RoomMin.Y, 0.f);
+						FVector EndLocation = FVector(RoomMax.X, RoomMin.Y, 0.f);
+
+						// Left wall
+						SpawnLightsAlongLength(StartLocation, EndLocation, FRotator(0.f, 90.f, 0.f), GapBetweenLights, LightActor.LightActor);
+						// Right wall
+						SpawnLightsAlongLength(FVector(RoomMin.X, RoomMax.Y, 0.f), FVector(RoomMax.X, RoomMax.Y, 0.f), FRotator(0.f, 270.f, 0.f), GapBetweenLights, LightActor.LightActor);
+						// Bottom wall
+						SpawnLightsAlongLength(StartLocation, FVector(RoomMin.X, RoomMax.Y, 0.f), FRotator(0.f), GapBetweenLights, LightActor.LightActor);
+						// Top wall
+						SpawnLightsAlongLength(EndLocation, FVector(RoomMax.X, RoomMax.Y, 0.f), FRotator(0.f, 180.f, 0.f), GapBetweenLights, LightActor.LightActor);
+					}
+						break;
+					case EObjectLocation::EOL_Ceiling: // Spawn ceiling light in the centre of the room on the ceiling
+					{
+						FVector StartLocation(0.f);
+						FVector EndLocation(0.f);
+
+						// Find which axis the room is longer in and spawn them along that axis
+						if (Room->Size.X >= Room->Size.Y)
+						{
+							float Y = Room->Position.Y + (Room->Size.Y / 2.f);
+							StartLocation = FVector(Room->Position.X, Y, RoomType->WallHeight);
+							EndLocation = FVector(Room->GetRoomMax().X, Y, RoomType->WallHeight);
+						}
+						else
+						{
+							float X = Room->Position.X + (Room->Size.X / 2.f);
+							StartLocation = FVector(X, Room->Position.Y, RoomType->WallHeight);
+							EndLocation = FVector(X, Room->GetRoomMax().Y, RoomType->WallHeight);
+						}
+
+						SpawnLightsAlongLength(StartLocation, EndLocation, FRotator(0.f), GapBetweenLights, LightActor.LightActor);
+					}
+						break;
+					default:
+						break;
+					}
+				}
+			}
+		}
+	}
+}
+
+void ADungeonGenerator::SpawnLightsAlongLength(FVector StartLocation, FVector EndLocation, FRotator Rotation, int32 GapBetweenLights, TSubclassOf<AActor> ActorToSpawn)
+{
+	int32 Length = (StartLocation - EndLocation).Size();
+
+	int32 NumberOfTilesNeeded = FMath::FloorToInt(Length / GapBetweenLights) * GapBetweenLights;
+	if (NumberOfTilesNeeded == Length)
+		NumberOfTilesNeeded -= GapBetweenLights;
+	int32 TilesOnEitherSide = (Length - NumberOfTilesNeeded) / 2;
+
+	// If length can fit more than one light with GapBetweenLights between them
+	if (TilesOnEitherSide > 0)
+	{
+		for (int32 i = TilesOnEitherSide; i < Length; i += GapBetweenLights)
+		{
+			FVector LightLocation = StartLocation * TileSize;
+
+			if (StartLocation.X == EndLocation.X)
+			{
+				LightLocation.Y += TileSize * i;
+			}
+			else
+			{
+				LightLocation.X += TileSize * i;
+			}
+
+			LightLocation -= DungeonOffset;
+			SpawnedActors.Add(GetWorld()->SpawnActor<AActor>(ActorToSpawn, LightLocation, Rotation));
+		}
+	}
+	else // else just spawn one light in the middle
+	{
+		FVector LightLocation = StartLocation * TileSize;
+		float Centre = Length / 2;
+		if (StartLocation.X == EndLocation.X)
+		{
+			LightLocation.Y += TileSize * Centre;
+		}
+		else
+		{
+			LightLocation.X += TileSize * Centre;
+		}
+
+		LightLocation -= DungeonOffset;
+		SpawnedActors.Add(GetWorld()->SpawnActor<AActor>(ActorToSpawn, LightLocation, Rotation));
+	}
+}
+
+FIntPoint ADungeonGenerator::WorldToTile(const FVector& WorldLocation) const
+{
+	FVector LocalLocation = GetActorTransform().InverseTransformPosition(WorldLocation) / TileSize;
+	return FIntPoint(FMath::FloorToInt(LocalLocation.X), FMath::FloorToInt(LocalLocation.Y));
+}
+
+FVector ADungeonGenerator::GetDoorwayLocation(const FIntPoint& TileA, const FIntPoint& TileB) const
+{
+	// Halfway between the centres of the two tiles
+	FVector LocalLocation = (FVector(TileA.X + TileB.X, TileA.Y + TileB.Y, 0.f) / 2.f + FVector(0.5f, 0.5f, 0.f)) * TileSize;
+	return GetActorTransform().TransformPosition(LocalLocation);
+}
+
+FDungeonPortal ADungeonGenerator::MakePortal(const FDungeonNavLink& Link) const
+{
+	const FDungeonNavDoor& FromDoor = Layout->NavigationData.Doors[Link.FromDoor];
+	const FDungeonNavDoor& ToDoor = Layout->NavigationData.Doors[Link.ToDoor];
+
+	FDungeonPortal Portal;
+	Portal.RoomIndex = FromDoor.RoomIndex;
+	Portal.ConnectedRoomIndex = ToDoor.RoomIndex;
+	Portal.Location = GetDoorwayLocation(FromDoor.RoomTile, FromDoor.CorridorTile);
+	Portal.ConnectedLocation = GetDoorwayLocation(ToDoor.CorridorTile, ToDoor.RoomTile);
+	Portal.CorridorLength = Link.Cost;
+
+	return Portal;
+}
+
+bool ADungeonGenerator::FindRoomPath(int32 StartRoomIndex, int32 GoalRoomIndex, TArray<FDungeonPortal>& OutPortals) const
+{
+	OutPortals.Reset();
+
+	TArray<int32> PathLinks;
+	if (!Layout->NavigationData.FindRoomPath(StartRoomIndex, GoalRoomIndex, PathLinks))
+	{
+		return false;
+	}
+
+	for (int32 LinkIndex : PathLinks)
+	{
+		OutPortals.Add(MakePortal(Layout->NavigationData.Links[LinkIndex]));
+	}
+
+	return true;
+}
+
+TArray<FDungeonPortal> ADungeonGenerator::GetRoomPortals(int32 RoomIndex) const
+{
+	TArray<FDungeonPortal> Portals;
+
+	for (const FDungeonNavLink& Link : Layout->NavigationData.GetRoomLinks(RoomIndex))
+	{
+		Portals.Add(MakePortal(Link));
+	}
+
+	return Portals;
+}
+
+bool ADungeonGenerator::IsLocationWalkable(const FVector& WorldLocation) const
+{
+	return Layout->NavigationData.IsWalkable(WorldToTile(WorldLocation));
+}
+
+bool ADungeonGenerator::GetRoomAtLocation(const FVector& WorldLocation, int32& OutRoomIndex) const
+{
+	FIntPoint Tile = WorldToTile(WorldLocation);
+	OutRoomIndex = Layout->TileGrid.GetTileType(Tile) == EDungeonTileType::Room ? Layout->TileGrid.GetTile(Tile).RoomIndex : INDEX_NONE;
+
+	return OutRoomIndex != INDEX_NONE;
+}
+
+bool ADungeonGenerator::GetCorridorAtLocation(const FVector& WorldLocation, int32& OutCorridorIndex) const
+{
+	FIntPoint Tile = WorldToTile(WorldLocation);
+	OutCorridorIndex = Layout->TileGrid.GetTileType(Tile) == EDungeonTileType::Corridor ? Layout->TileGrid.GetTile(Tile).CorridorIndex : INDEX_NONE;
+
+	return OutCorridorIndex != INDEX_NONE;
+}
+
+void ADungeonGenerator::GetRoomsInBox(const FBox& WorldBox, TArray<int32>& OutRoomIndexes) const
+{
+	OutRoomIndexes.Reset();
+
+	if (Layout->TileGrid.Num() == 0)
+	{
+		return;
+	}
+
+	// Clamp the box to the grid, the corners can swap over if the actor is rotated
+	FIntPoint CornerA = WorldToTile(WorldBox.Min);
+	FIntPoint CornerB = WorldToTile(WorldBox.Max);
+	FIntPoint Min(FMath::Max(FMath::Min(CornerA.X, CornerB.X), Layout->TileGrid.Origin.X), FMath::Max(FMath::Min(CornerA.Y, CornerB.Y), Layout->TileGrid.Origin.Y));
+	FIntPoint Max(FMath::Min(FMath::Max(CornerA.X, CornerB.X), Layout->TileGrid.Origin.X + Layout->TileGrid.Width - 1), FMath::Min(FMath::Max(CornerA.Y, CornerB.Y), Layout->TileGrid.Origin.Y + Layout->TileGrid.Height - 1));
+
+	for (int32 x = Min.X; x <= Max.X; x++)
+	{
+		for (int32 y = Min.Y; y <= Max.Y; y++)
+		{
+			const FDungeonTile& Tile = Layout->TileGrid.GetTile(FIntPoint(x, y));
+
+			if (Tile.Type != EDungeonTileType::Room)
+			{
+				continue;
+			}
+
+			OutRoomIndexes.AddUnique(Tile.RoomIndex);
+
+			// Skip the rest of the room along this column
+			y = Rooms[Tile.RoomIndex]->GetRoomRect().Max.Y - 1;
+		}
+	}
+}
+
+void ADungeonGenerator::GetNeighbouringRooms(int32 RoomIndex, TArray<int32>& OutRoomIndexes) const
+{
+	OutRoomIndexes.Reset();
+
+	if (!Rooms.IsValidIndex(RoomIndex) || !Layout->RoomNeighbourStarts.IsValidIndex(RoomIndex + 1))
+	{
+		return;
+	}
+
+	OutRoomIndexes.Append(Layout->RoomNeighbours.GetData() + Layout->RoomNeighbourStarts[RoomIndex], Layout->RoomNeighbourStarts[RoomIndex + 1] - Layout->RoomNeighbourStarts[RoomIndex]);
+}
+
+FBox ADungeonGenerator::GetRoomBounds(int32 RoomIndex) const
+{
+	if (!Rooms.IsValidIndex(RoomIndex))
+	{
+		return FBox(ForceInit);
+	}
+
+	FIntRect RoomRect = Rooms[RoomIndex]->GetRoomRect();
+	FBox LocalBounds(FVector(RoomRect.Min.X, RoomRect.Min.Y, 0.f) * TileSize, FVector(RoomRect.Max.X, RoomRect.Max.Y, 0.f) * TileSize);
+
+	return LocalBounds.TransformBy(GetActorTransform());
+}
+
+float FDungeonBudget::GetUsage(const FDungeonBudgetEstimate& Estimate) const
+{
+	float Usage = 0.f;
+
+	if (MaxInstances > 0)
+		Usage = FMath::Max(Usage, Estimate.NumInstances / MaxInstances);
+	if (MaxLights > 0)
+		Usage = FMath::Max(Usage, Estimate.NumLights / MaxLights);
+	if (MaxComponents > 0)
+		Usage = FMath::Max(Usage, Estimate.NumComponents / MaxComponents);
+	if (MaxMemoryMB > 0.f)
+		Usage = FMath::Max(Usage, (Estimate.GPUMemoryMB + Estimate.CPUMemoryMB) / MaxMemoryMB);
+
+	return Usage;
+}
+
+FDungeonBudgetEstimate ADungeonGenerator::EstimateBudget(int32 Seed)
+{
+	FDungeonLayoutSettings Settings = MakeLayoutSettings();
+	Settings.Seed = Seed;
+	Settings.bRasterizeMinimap = false;
+
+	return EstimateLayoutBudget(*LayoutGenerator.Generate(Settings));
+}
+
+FDungeonBudgetEstimate ADungeonGenerator::EstimateLayoutBudget(const FDungeonLayout& EstimatedLayout) const
+{
+	FDungeonBudgetEstimate Estimate;
+	Estimate.Seed = EstimatedLayout.Settings.Seed;
+
+	float NumCustomDataFloats = 0.f;
+
+	// Props and templates share a component per mesh however many rooms use them
+	TSet<UStaticMesh*> SharedMeshes;
+
+	auto AddInstances = [&](UStaticMesh* Mesh, float Count, int32 NumCustomData)
+	{
+		if (Mesh && Count > 0.f)
+		{
+			Estimate.InstancesPerMesh.FindOrAdd(Mesh) += Count;
+			Estimate.NumInstances += Count;
+			NumCustomDataFloats += Count * NumCustomData;
+		}
+	};
+
+	// Each tile is picked with a uniform index then kept using its weight, so its chance is its weight over the total
+	auto AddRandomTiles = [&](const TArray<FRandomTile>& Tiles, float Count)
+	{
+		float TotalWeight = 0.f;
+
+		for (const FRandomTile& Tile : Tiles)
+		{
+			TotalWeight += GetPickWeight(Tile.Probability);
+		}
+
+		for (const FRandomTile& Tile : Tiles)
+		{
+			AddInstances(Tile.Mesh, Count * GetPickWeight(Tile.Probability) / TotalWeight, Tile.CustomData.Num());
+		}
+	};
+
+	auto AddAllTiles = [&](const TArray<FRandomTile>& Tiles, float Count)
+	{
+		for (const FRandomTile& Tile : Tiles)
+		{
+			AddInstances(Tile.Mesh, Count, Tile.CustomData.Num());
+		}
+	};
+
+	// The components CreateInstancedStaticMeshComponents makes for the tiles
+	auto CountComponents = [this](const TArray<FRandomTile>& Tiles)
+	{
+		if (!bShareVariantComponents)
+		{
+			return Tiles.Num();
+		}
+
+		int32 NumComponents = 0;
+
+		for (int32 TileIndex = 0; TileIndex < Tiles.Num(); TileIndex++)
+		{
+			bool bIsFirstUse = true;
+
+			for (int32 i = 0; i < TileIndex; i++)
+			{
+				if (Tiles[i].Mesh == Tiles[TileIndex].Mesh)
+				{
+					bIsFirstUse = false;
+					break;
+				}
+			}
+
+			NumComponents += bIsFirstUse ? 1 : 0;
+		}
+
+		return NumComponents;
+	};
+
+	// Corridors, the same tiles SpawnCorridorTiles adds
+	const FDungeonTileGrid& TileGrid = EstimatedLayout.TileGrid;
+	int32 NumCorridorTiles = 0;
+	int32 NumCorridorWalls = 0;
+
+	for (int32 Index = 0; Index < TileGrid.Num(); Index++)
+	{
+		const FDungeonTile& Tile = TileGrid.Tiles[Index];
+
+		if (Tile.Type != EDungeonTileType::Corridor)
+		{
+			continue;
+		}
+
+		FIntPoint Cell = TileGrid.ToCell(Index);
+		NumCorridorTiles++;
+
+		for (uint8 Side = 0; Side < 4; Side++)
+		{
+			if (!(Tile.DoorMask & (1 << Side)) && TileGrid.GetTileType(FDungeonTileGrid::GetNeighbour(Cell, static_cast<EDungeonDirection>(Side))) != EDungeonTileType::Corridor)
+			{
+				NumCorridorWalls++;
+			}
+		}
+	}
+
+	AddRandomTiles(CorridorFloorTileMeshes, NumCorridorTiles);
+	AddRandomTiles(CorridorCeilingTileMeshes, NumCorridorTiles);
+	AddRandomTiles(CorridorWallTileMeshes, NumCorridorWalls);
+	Estimate.NumComponents += CountComponents(CorridorFloorTileMeshes) + CountComponents(CorridorWallTileMeshes) + CountComponents(CorridorCeilingTileMeshes);
+
+	// Rooms, averaged over every room type that fits
+	TArray<const FRoomType*> RoomTypes;
+
+	if (RoomTypesDataTable)
+	{
+		for (const TPair<FName, uint8*>& Row : RoomTypesDataTable->GetRowMap())
+		{
+			RoomTypes.Add(reinterpret_cast<const FRoomType*>(Row.Value));
+		}
+	}
+
+	TArray<FIntPoint, TInlineAllocator<8>> DoorLocations;
+
+	for (int32 RoomIndex = 0; RoomIndex < EstimatedLayout.Rooms.Num(); RoomIndex++)
+	{
+		FIntRect RoomRect = EstimatedLayout.Rooms[RoomIndex].GetRoomRect();
+		float TotalWeight = 0.f;
+
+		DoorLocations.Reset();
+
+		for (const FDungeonLayoutDoor& Door : EstimatedLayout.GetRoomDoors(RoomIndex))
+		{
+			DoorLocations.Add(Door.GetPivot());
+		}
+
+		for (const FRoomType* RoomType : RoomTypes)
+		{
+			TotalWeight += CanUseRoomType(RoomRect, DoorLocations, *RoomType) ? GetPickWeight(RoomType->Probability) : 0.f;
+		}
+
+		for (const FRoomType* RoomType : RoomTypes)
+		{
+			if (TotalWeight <= 0.f || !CanUseRoomType(RoomRect, DoorLocations, *RoomType))
+			{
+				continue;
+			}
+
+			float Chance = GetPickWeight(RoomType->Probability) / TotalWeight;
+			int32 NumFloorTiles = RoomRect.Area();
+
+			if (RoomType->Template)
+			{
+				for (const FRoomTemplateMesh& TemplateMesh : RoomType->Template->Meshes)
+				{
+					AddInstances(TemplateMesh.Mesh, TemplateMesh.Transforms.Num() * Chance, 0);
+					SharedMeshes.Add(TemplateMesh.Mesh);
+				}
+			}
+			else
+			{
+				int32 NumDoors = DoorLocations.Num();
+				int32 NumWallTiles = FMath::Max(2 * (RoomRect.Width() + RoomRect.Height()) * RoomType->WallHeight - NumDoors, 0);
+
+				AddRandomTiles(RoomType->FloorTileMeshes, NumFloorTiles * Chance);
+				AddRandomTiles(RoomType->CeilingTileMeshes, NumFloorTiles * Chance);
+				AddRandomTiles(RoomType->WallTileMeshes, NumWallTiles * Chance);
+				AddRandomTiles(RoomType->DoorTileMeshes, NumDoors * Chance);
+				AddAllTiles(RoomType->WallAdditionTileMeshes, NumWallTiles * Chance);
+				AddAllTiles(RoomType->DoorAdditionTileMeshes, NumDoors * Chance);
+
+				Estimate.NumComponents += Chance * (CountComponents(RoomType->FloorTileMeshes) + CountComponents(RoomType->CeilingTileMeshes)
+					+ CountComponents(RoomType->WallTileMeshes) + CountComponents(RoomType->DoorTileMeshes)
+					+ CountComponents(RoomType->WallAdditionTileMeshes) + CountComponents(RoomType->DoorAdditionTileMeshes));
+			}
+
+			if (bUseRoomProxies && RoomType->WallHeight > 0)
+			{
+				Estimate.NumComponents += Chance;
+			}
+
+			for (const FLightSource& LightSource : RoomType->LightActors)
+			{
+				int32 GapBetweenLights = LightSource.TileDistanceBetweenNext == 0 ? 1 : LightSource.TileDistanceBetweenNext;
+
+				if (LightSource.Location == EObjectLocation::EOL_AroundRoom)
+				{
+					Estimate.NumLights += Chance * 2 * (GetNumLightsAlongLength(RoomRect.Width(), GapBetweenLights) + GetNumLightsAlongLength(RoomRect.Height(), GapBetweenLights));
+				}
+				else if (LightSource.Location == EObjectLocation::EOL_Ceiling)
+				{
+					Estimate.NumLights += Chance * GetNumLightsAlongLength(FMath::Max(RoomRect.Width(), RoomRect.Height()), GapBetweenLights);
+				}
+			}
+
+			for (const FRoomPropScatter& Scatter : RoomType->PropScatters)
+			{
+				FVector2D ScatterSize = FVector2D(RoomRect.Size()) - 2.f * Scatter.WallClearance;
+
+				if (ScatterSize.X <= 0.f || ScatterSize.Y <= 0.f || Scatter.MinDistance <= 0.f)
+				{
+					continue;
+				}
+
+				float NumPoints = FMath::Min<float>(Scatter.MaxPoints, ScatterSize.X * ScatterSize.Y * PoissonPointsPerArea / FMath::Square(Scatter.MinDistance));
+				AddRandomTiles(Scatter.PropMeshes, NumPoints * Chance);
+
+				for (const FRandomTile& Prop : Scatter.PropMeshes)
+				{
+					SharedMeshes.Add(Prop.Mesh);
+				}
+			}
+		}
+	}
+
+	SharedMeshes.Remove(nullptr);
+	Estimate.NumComponents += SharedMeshes.Num();
+
+	// The custom data is held on both the game and render threads
+	float GPUBytes = Estimate.NumInstances * GPUBytesPerInstance + NumCustomDataFloats * sizeof(float);
+	float CPUBytes = Estimate.NumInstances * CPUBytesPerInstance + NumCustomDataFloats * sizeof(float) * 2.f + Estimate.NumComponents * CPUBytesPerComponent;
+
+	Estimate.GPUMemoryMB = GPUBytes / (1024.f * 1024.f);
+	Estimate.CPUMemoryMB = CPUBytes / (1024.f * 1024.f);
+	Estimate.bWithinBudget = Budget.GetUsage(Estimate) <= 1.f;
+
+	return Estimate;
+}
+
+void ADungeonGenerator::SelectSeedWithinBudget()
+{
+	int32 InitialSeed = Stream.GetInitialSeed();
+	FDungeonLayoutSettings Settings = MakeLayoutSettings();
+
+	// The candidate layouts are only estimated, none of them are drawn
+	Settings.bRasterizeMinimap = false;
+
+	// Most seeds fit, so only the first is estimated before trying the rest
+	LastBudgetEstimate = EstimateLayoutBudget(*LayoutGenerator.Generate(Settings));
+
+	if (LastBudgetEstimate.bWithinBudget)
+	{
+		return;
+	}
+
+	TArray<FDungeonLayoutSettings> Jobs;
+
+	for (uint32 Attempt = 1; Jobs.Num() < MaxBudgetSeedAttempts - 1; Attempt++)
+	{
+		// Added as unsigned so seeds near MAX_int32 wrap around rather than overflow
+		int32 CandidateSeed = static_cast<int32>(static_cast<uint32>(InitialSeed) + Attempt);
+
+		// A seed of 0 would make the clients generate a new seed of their own
+		if (CandidateSeed != 0)
+		{
+			Settings.Seed = CandidateSeed;
+			Jobs.Add(Settings);
+		}
+	}
+
+	TArray<FDungeonLayoutPtr> Layouts;
+
+	if (Jobs.Num() > 0)
+	{
+		FDungeonGenerationService::Get().GenerateBatch(Jobs, Layouts);
+	}
+
+	float LowestUsage = Budget.GetUsage(LastBudgetEstimate);
+	FDungeonBudgetEstimate CheapestEstimate = LastBudgetEstimate;
+
+	for (const FDungeonLayoutPtr& CandidateLayout : Layouts)
+	{
+		FDungeonBudgetEstimate Estimate = EstimateLayoutBudget(*CandidateLayout);
+		float Usage = Budget.GetUsage(Estimate);
+
+		if (Usage < LowestUsage)
+		{
+			LowestUsage = Usage;
+			CheapestEstimate = Estimate;
+		}
+
+		if (Estimate.bWithinBudget)
+		{
+			break;
+		}
+	}
+
+	if (!CheapestEstimate.bWithinBudget)
+	{
+		UE_LOG(LogDungeonGenerator, Warning, TEXT("None of the %d seeds from %d fit the budget, using seed %d at %.0f%% of the budget"), MaxBudgetSeedAttempts, InitialSeed, CheapestEstimate.Seed, LowestUsage * 100.f);
+	}
+	else
+	{
+		UE_LOG(LogDungeonGenerator, Log, TEXT("Seed %d was over budget, using seed %d instead"), InitialSeed, CheapestEstimate.Seed);
+	}
+
+	LastBudgetEstimate = CheapestEstimate;
+	Stream.Initialize(CheapestEstimate.Seed);
+}
+
+TArray<FVector> ADungeonGenerator::GetRoomSpawnPoints(int32 RoomIndex) const
+{
+	if (!RoomSpawnPointStarts.IsValidIndex(RoomIndex + 1))
+	{
+		return TArray<FVector>();
+	}
+
+	return TArray<FVector>(SpawnPoints.GetData() + RoomSpawnPointStarts[RoomIndex], RoomSpawnPointStarts[RoomIndex + 1] - RoomSpawnPointStarts[RoomIndex]);
+}
+
+FVector2D ADungeonGenerator::GetMinimapUV(const FVector& WorldLocation) const
+{
+	const FDungeonTileGrid& TileGrid = Layout->TileGrid;
+
+	if (TileGrid.Num() == 0)
+	{
+		return FVector2D::ZeroVector;
+	}
+
+	FVector LocalLocation = GetActorTransform().InverseTransformPosition(WorldLocation) / TileSize;
+	return FVector2D((LocalLocation.X - TileGrid.Origin.X) / TileGrid.Width, (LocalLocation.Y - TileGrid.Origin.Y) / TileGrid.Height);
+}
+
+void ADungeonGenerator::RevealAroundLocation(const FVector& WorldLocation, int32 Radius)
+{
+	Radius = FMath::Max(Radius, 0);
+	FIntPoint Centre = WorldToTile(WorldLocation);
+	FIntPoint Extent(Radius, Radius);
+
+	RevealMinimapTiles(FIntRect(Centre - Extent, Centre + Extent + FIntPoint(1, 1)), Centre, Radius);
+}
+
+void ADungeonGenerator::RevealRoom(int32 RoomIndex)
+{
+	if (Rooms.IsValidIndex(RoomIndex))
+	{
+		RevealMinimapTiles(Rooms[RoomIndex]->GetRoomRect(), FIntPoint::ZeroValue, INDEX_NONE);
+	}
+}
+
+void ADungeonGenerator::CreateMinimapTexture()
+{
+	const FDungeonTileGrid& TileGrid = Layout->TileGrid;
+
+	// Nothing draws the minimap on a dedicated server
+	if (GetNetMode() == NM_DedicatedServer || Layout->MinimapPixels.Num() == 0)
+	{
+		return;
+	}
+
+	// Copied into the existing buffer so it is only reallocated when the dungeon grows
+	MinimapPixels.Reset();
+	MinimapPixels.Append(Layout->MinimapPixels);
+
+	if (!MinimapTexture || MinimapTexture->GetSizeX() != TileGrid.Width || MinimapTexture->GetSizeY() != TileGrid.Height)
+	{
+		MinimapTexture = UTexture2D::CreateTransient(TileGrid.Width, TileGrid.Height, PF_B8G8R8A8);
+		MinimapTexture->Filter = TF_Nearest;
+		MinimapTexture->SRGB = false;
+		MinimapTexture->AddressX = TA_Clamp;
+		MinimapTexture->AddressY = TA_Clamp;
+	}
+
+	// FColor is laid out as BGRA so the texels can be copied straight in
+	FTexture2DMipMap& Mip = MinimapTexture->PlatformData->Mips[0];
+	void* MipData = Mip.BulkData.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(MipData, MinimapPixels.GetData(), MinimapPixels.Num() * sizeof(FColor));
+	Mip.BulkData.Unlock();
+
+	MinimapTexture->UpdateResource();
+}
+
+void ADungeonGenerator::RevealMinimapTiles(FIntRect TileRect, const FIntPoint& Centre, int32 Radius)
+{
+	const FDungeonTileGrid& TileGrid = Layout->TileGrid;
+
+	if (!MinimapTexture || MinimapPixels.Num() != TileGrid.Num())
+	{
+		return;
+	}
+
+	TileRect.Clip(FIntRect(TileGrid.Origin, TileGrid.Origin + FIntPoint(TileGrid.Width, TileGrid.Height)));
+
+	// The texels that changed, in texture space
+	FIntPoint ChangedMin(MAX_int32, MAX_int32);
+	FIntPoint ChangedMax(MIN_int32, MIN_int32);
+
+	for (int32 y = TileRect.Min.Y; y < TileRect.Max.Y; y++)
+	{
+		for (int32 x = TileRect.Min.X; x < TileRect.Max.X; x++)
+		{
+			if (Radius != INDEX_NONE && FMath::Square(x - Centre.X) + FMath::Square(y - Centre.Y) > FMath::Square(Radius))
+			{
+				continue;
+			}
+
+			FIntPoint Texel = FIntPoint(x, y) - TileGrid.Origin;
+			FColor& Pixel = MinimapPixels[Texel.Y * TileGrid.Width + Texel.X];
+
+			if (Pixel.A == 0)
+			{
+				Pixel.A = 255;
+				ChangedMin = ChangedMin.ComponentMin(Texel);
+				ChangedMax = ChangedMax.ComponentMax(Texel);
+			}
+		}
+	}
+
+	if (ChangedMin.X > ChangedMax.X)
+	{
+		return;
+	}
+
+	// The render thread reads the region after this returns, so it gets its own copy which is freed once uploaded
+	FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(ChangedMin.X, ChangedMin.Y, 0, 0, ChangedMax.X - ChangedMin.X + 1, ChangedMax.Y - ChangedMin.Y + 1);
+	FColor* RegionPixels = new FColor[Region->Width * Region->Height];
+
+	for (uint32 Row = 0; Row < Region->Height; Row++)
+	{
+		FMemory::Memcpy(RegionPixels + Row * Region->Width, &MinimapPixels[(ChangedMin.Y + Row) * TileGrid.Width + ChangedMin.X], Region->Width * sizeof(FColor));
+	}
+
+	MinimapTexture->UpdateTextureRegions(0, 1, Region, Region->Width * sizeof(FColor), sizeof(FColor), reinterpret_cast<uint8*>(RegionPixels),
+		[](uint8* SrcData, const FUpdateTextureRegion2D* Regions)
+		{
+			delete[] reinterpret_cast<FColor*>(SrcData);
+			delete Regions;
+		});
 }
\ No newline at end of file
@@ -1,245 +1,796 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/Actor.h"
-#include "Engine/DataTable.h"
-#include "Room.h"
-#include "Generator.h"
-#include "DungeonGenerator.generated.h"
-
-UENUM(BlueprintType)
-enum class EObjectLocation : uint8
-{
-	EOL_AroundRoom UMETA(DisplayName = "AroundRoom"),
-	EOL_Ceiling UMETA(DisplayName = "Ceiling")
-};
-
-USTRUCT(BlueprintType)
-struct FLightSource
-{
-	GENERATED_BODY()
-
-	/** The light actor to spawn */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TSubclassOf<AActor> LightActor;
-
-	/** The tile distance between each light */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	int32 TileDistanceBetweenNext;
-	
-	/** The section of the room the lights will be placed along */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	EObjectLocation Location;
-};
-
-USTRUCT(BlueprintType)
-struct FTile
-{
-	GENERATED_BODY()
-
-	/** The mesh to be used as the tile */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	UStaticMesh* Mesh;
-
-	/** The InstancedStaticMeshComponent to be used to spawn the tile */
-	UInstancedStaticMeshComponent* InstancedMeshComponent;
-};
-
-USTRUCT(BlueprintType)
-struct FRandomTile : public FTile
-{
-	GENERATED_BODY()
-
-	/** The probability of the mesh being spawned */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	float Probability;
-};
-
-USTRUCT(BlueprintType)
-struct FRoomType : public FTableRowBase
-{
-	GENERATED_BODY()
-
-	/** The meshes to be used as the floor tiles */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FRandomTile> FloorTileMeshes;
-
-	/** The meshes to be used as the wall tiles */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FRandomTile> WallTileMeshes;
-
-	/** The meshes to be used as the wall addition tiles */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FRandomTile> WallAdditionTileMeshes;
-
-	/** The meshes to be used as the door tiles */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FRandomTile> DoorTileMeshes;
-
-	/** The meshes to be used as the door addition tiles */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FRandomTile> DoorAdditionTileMeshes;
-
-	/** The meshes to be used as the ceiling tiles */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FRandomTile> CeilingTileMeshes;
-	
-	/** The light actors to be spawned in room */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	TArray<FLightSource> LightActors;
-	
-	/** The number of tiles high the room is */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	int32 WallHeight;
-
-	/** The probability of this room being spawned */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly)
-	float Probability;
-};
-
-USTRUCT()
-struct FConnectingRoom
-{
-	GENERATED_BODY()
-
-	/** The indexes of the rooms in the Rooms array */
-	int32 RoomAIndex;
-	int32 RoomBIndex;
-};
-
-UCLASS()
-class DUNGEON_CPP_API ADungeonGenerator : public AGenerator
-{
-	GENERATED_BODY()
-	
-public:	
-	
-	ADungeonGenerator();
-
-	/** The room types data */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Rooms")
-	class UDataTable* RoomTypesDataTable;
-
-	/** The size of each tile, this needs to match the width and height of the selected tiles */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
-	int32 TileSize;
-
-	/** The minimum number of tiles a room can have */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
-	int32 MinRoomSize;
-
-	/** The maximum number of tiles a room can have */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
-	int32 MaxRoomSize;
-
-	/** The minimum number of tiles a room can have */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
-	int32 MinRoomDistance;
-
-	/** The maximum number of tiles a room can have */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
-	int32 MaxRoomDistance;
-
-	/** The maximum number of rooms to generate */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
-	int32 NumberOfRooms;
-
-	/** The tiles to be used for each section of the rooms */
-	TArray<FRandomTile> RoomFloorTiles;
-	TArray<FRandomTile> RoomWallTiles;
-	TArray<FRandomTile> RoomWallAdditionTiles;
-	TArray<FRandomTile> RoomCeilingTiles;
-	TArray<FRandomTile> RoomDoorTiles;
-	TArray<FRandomTile> RoomDoorAdditionTiles;
-
-	/** The meshes to be used as the floor tiles in the corridors */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Corridors")
-	TArray<FRandomTile> CorridorFloorTileMeshes;
-
-	/** The meshes to be used as the wall tiles in the corridors */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Corridors")
-	TArray<FRandomTile> CorridorWallTileMeshes;
-
-	/** The meshes to be used as the ceiling tiles in the corridors */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Corridors")
-	TArray<FRandomTile> CorridorCeilingTileMeshes;
-
-	/** The tiles to be used for each section of the corridors */
-	TArray<FRandomTile> CorridorFloorTiles;
-	TArray<FRandomTile> CorridorWallTiles;
-	TArray<FRandomTile> CorridorCeilingTiles;
-	
-	/** The text to use for the FRandomStream */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dungeon | Stream")
-	int32 StreamInput;
-
-private:
-
-	/** The generated rooms */
-	TArray<URoom*> Rooms;
-
-	/** Each room connection contains the index of the two rooms */
-	TArray<FConnectingRoom> RoomConnections;
-
-	/** The amount the dungeon has been moved to align with the starting area */
-	FVector DungeonOffset;
-
-protected:
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
-
-private:
-
-	/** Places a newly generated room if it doesn't overlap with an existing room */
-	URoom* TryPlaceRoom();
-
-	/** Generates a Room using MinRoomSize and MaxRoomSize */
-	URoom* GenerateNewRoom();
-
-	/** Checks if RoomToCheck overlaps with any of the rooms in the Rooms array */
-	void CheckRoomIsNotOverlappingOtherRooms(URoom*& RoomToCheck);
-
-	/** Spawns a random tile from the TilesArray at the AtLocation*/
-	void SpawnRandomTile(const TArray<FRandomTile>& InstancedTileMeshesArray, const FTransform& AtLocation);
-
-	/** Spawns a random tile from the TilesArray at the AtLocation*/
-	void SpawnAllTiles(const TArray<FRandomTile>& InstancedTileMeshesArray, const FTransform& AtLocation, const int32 CurrentHeight);
-
-	/** Loops through the Rooms array and spawns the tiles */
-	void SpawnRooms();
-
-	/** Creates arrays of InstancedStaticMeshes from the SelectedRoomType to be spawned */
-	void CreateInstancedStaticMeshesForCurrentRoom(FRoomType*& SelectedRoomType);
-
-	/** Randomly selects a row from the RoomTypes DataTable and applies it to the CurrentRoom  */
-	FRoomType* PickRandomRoomTypeForRoom(URoom*& CurrentRoom);
-
-	/** Spawn floor tiles from the CorridorStart to the CorridorEnd */
-	void SpawnCorridorTiles(const FVector& CorridorStart, const FVector& CorridorEnd);
-
-	/** Spawn walls for the passed in URoom */
-	void SpawnRoomWalls(URoom*& Room);
-
-	/** Spawns wall and door tiles from the StartPoint to the EndPoint with the Rotation */
-	void SpawnWall(FVector& StartPoint, FVector& EndPoint, FRotator& Rotation, const int32& Height, TArray<FVector> DoorLocations);
-
-	/** Spawns the corridor tiles between the rooms in each FConnectingRoom */
-	void CreateCorridors(const TArray<FConnectingRoom> &ConnectingRooms);
-		
-	/**  Finds the lowest room on the X and aligns the center of it with the starting location */
-	void MoveDungeonToStartArea();
-
-	/** Create InstancedStaticMeshComponent from the Meshes passed in */
-	void CreateInstancedStaticMeshComponents(const TArray<FRandomTile>& TileMeshes, TArray<FRandomTile>& InstancedTileMeshes);
-
-	/** Spawns light sources in all rooms */
-	void SpawnLightsInRooms();
-
-	/** Pick a random point where the two rooms will still overlap, pass in all X values or Y values */
-	int32 GetRandomPointWhereRoomsOverlap(const float ConnectingRoomPosition, const float ConnectingRoomExtent, const float NewRoomSize);
-
-	/** Spawns as many lights as possible from StartLocation to EndLocation with at least the GapBetweenLights between them */
-	void SpawnLightsAlongLength(FVector StartLocation, FVector EndLocation, FRotator Rotation, int32 GapBetweenLights, TSubclassOf<AActor> ActorToSpawn);
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Engine/DataTable.h"
+#include "Room.h"
+#include "Generator.h"
+#include "DungeonLayout.h"
+#include "DungeonGenerator.generated.h"
+
+UENUM(BlueprintType)
+enum class EObjectLocation : uint8
+{
+	EOL_AroundRoom UMETA(DisplayName = "AroundRoom"),
+	EOL_Ceiling UMETA(DisplayName = "Ceiling")
+};
+
+USTRUCT(BlueprintType)
+struct FLightSource
+{
+	GENERATED_BODY()
+
+	/** The light actor to spawn */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TSubclassOf<AActor> LightActor;
+
+	/** The tile distance between each light */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	int32 TileDistanceBetweenNext;
+	
+	/** The section of the room the lights will be placed along */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	EObjectLocation Location;
+};
+
+USTRUCT(BlueprintType)
+struct FTile
+{
+	GENERATED_BODY()
+
+	/** The mesh to be used as the tile */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	UStaticMesh* Mesh;
+
+	/** The InstancedStaticMeshComponent to be used to spawn the tile */
+	UInstancedStaticMeshComponent* InstancedMeshComponent;
+};
+
+USTRUCT(BlueprintType)
+struct FRandomTile : public FTile
+{
+	GENERATED_BODY()
+
+	/** The probability of the mesh being spawned */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float Probability;
+
+	/** Per instance custom data given to the tile when it's spawned, read in the material with PerInstanceCustomData */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<float> CustomData;
+};
+
+/** Points scattered over a room's floor so that none are closer together than MinDistance */
+USTRUCT(BlueprintType)
+struct FRoomScatter
+{
+	GENERATED_BODY()
+
+	/** The minimum number of tiles between two points */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.1"))
+	float MinDistance = 1.f;
+
+	/** The minimum number of tiles between a point and the walls */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0"))
+	float WallClearance = 0.5f;
+
+	/** The most points placed in a room, fewer are placed once the room is full */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	int32 MaxPoints = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FRoomPropScatter : public FRoomScatter
+{
+	GENERATED_BODY()
+
+	/** The meshes placed at each point, picked using their probability */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FRandomTile> PropMeshes;
+
+	/** Whether each prop is turned to a random yaw */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	bool bRandomYaw = true;
+};
+
+USTRUCT(BlueprintType)
+struct FRoomType : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	/** The meshes to be used as the floor tiles */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FRandomTile> FloorTileMeshes;
+
+	/** The meshes to be used as the wall tiles */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FRandomTile> WallTileMeshes;
+
+	/** The meshes to be used as the wall addition tiles */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FRandomTile> WallAdditionTileMeshes;
+
+	/** The meshes to be used as the door tiles */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FRandomTile> DoorTileMeshes;
+
+	/** The meshes to be used as the door addition tiles */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FRandomTile> DoorAdditionTileMeshes;
+
+	/** The meshes to be used as the ceiling tiles */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FRandomTile> CeilingTileMeshes;
+	
+	/** The light actors to be spawned in room */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FLightSource> LightActors;
+	
+	/** The props scattered over the floor, each scatter keeps its MinDistance from the props of the scatters before it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FRoomPropScatter> PropScatters;
+
+	/** Where enemies and pickups can be spawned, kept clear of the props */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	FRoomScatter SpawnPointScatter;
+
+	/** A hand built room stamped in place of the tiles, the room type is then only picked for rooms matching its footprint and door sockets */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	class URoomTemplate* Template;
+
+	/** The number of tiles high the room is */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	int32 WallHeight;
+
+	/** The probability of this room being spawned */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	float Probability;
+};
+
+/** What spawning a dungeon is expected to cost, worked out from the layout alone */
+USTRUCT(BlueprintType)
+struct FDungeonBudgetEstimate
+{
+	GENERATED_BODY()
+
+	/** The seed the estimate is for */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 Seed = 0;
+
+	/** The expected number of instances of each mesh, averaged over the room type and tile picks */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TMap<UStaticMesh*, float> InstancesPerMesh;
+
+	/** The expected number of instances, before duplicate and hidden tiles are culled */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float NumInstances = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float NumLights = 0.f;
+
+	/** The expected number of instanced mesh and proxy components, the simplified collision isn't counted */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float NumComponents = 0.f;
+
+	/** Rough memory of the instance buffers on the GPU and the instance data and components on the CPU */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float GPUMemoryMB = 0.f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float CPUMemoryMB = 0.f;
+
+	/** Whether the estimate is within the generator's Budget */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	bool bWithinBudget = true;
+};
+
+/** The most a dungeon is allowed to cost, 0 means no limit */
+USTRUCT(BlueprintType)
+struct FDungeonBudget
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 MaxInstances = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 MaxLights = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	int32 MaxComponents = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.0"))
+	float MaxMemoryMB = 0.f;
+
+	/** Returns how much of the budget the estimate uses on its most used limit, over 1 is over budget */
+	float GetUsage(const FDungeonBudgetEstimate& Estimate) const;
+};
+
+/** What clients need to generate the same dungeon as the server */
+USTRUCT()
+struct FDungeonSeed
+{
+	GENERATED_BODY()
+
+	/** The initial seed of the server's FRandomStream */
+	UPROPERTY()
+	int32 Seed = 0;
+
+	/** The server's ConfigVersion, INDEX_NONE until it has replicated */
+	UPROPERTY()
+	int32 ConfigVersion = INDEX_NONE;
+};
+
+/** A tile waiting to be added to its InstancedStaticMeshComponent */
+struct FPendingTileInstance
+{
+	UInstancedStaticMeshComponent* InstancedMeshComponent;
+	FTransform Transform;
+
+	/** Where the tile's custom data starts in the PendingCustomData and how many values it has */
+	int32 CustomDataOffset;
+	int32 NumCustomData;
+};
+
+/** Where a pending tile ends up, tiles with the same key draw exactly the same thing */
+struct FTileInstanceKey
+{
+	const UStaticMesh* Mesh;
+	FIntVector Location;
+	int32 Quarter;
+
+	/** Where the instance is in PendingTileInstances */
+	int32 Index;
+
+	bool IsSameInstance(const FTileInstanceKey& Other) const
+	{
+		return Mesh == Other.Mesh && Location == Other.Location && Quarter == Other.Quarter;
+	}
+};
+
+/** The props and spawn points scattered over a room, filled on a worker thread */
+struct FRoomPopulation
+{
+	const FRoomType* RoomType;
+
+	/** The seed of the room's own stream, taken from the generator's stream in room order */
+	int32 Seed;
+
+	/** The points in tiles, each prop scatter's points followed by the spawn points */
+	TArray<FVector2D> Points;
+
+	/** Where each prop scatter's points start in Points, the last entry is where the spawn points start */
+	TArray<int32> ScatterStarts;
+
+	/** The index of the mesh in its scatter's PropMeshes and the yaw of each prop point */
+	TArray<int32> MeshIndexes;
+	TArray<float> Yaws;
+};
+
+/** The geometry of one section of a room proxy, kept between rooms so the buffers are reused */
+struct FRoomProxySection
+{
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UVs;
+
+	void Reset();
+
+	/** Adds a quad from Corner along AxisU and AxisV, wound to face Normal. The UVs repeat once per tile */
+	void AddQuad(const FVector& Corner, const FVector& AxisU, const FVector& AxisV, const FVector& Normal, float TileSize);
+};
+
+UCLASS()
+class DUNGEON_CPP_API ADungeonGenerator : public AGenerator
+{
+	GENERATED_BODY()
+	
+public:	
+	
+	ADungeonGenerator();
+
+	/** The room types data */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Rooms")
+	class UDataTable* RoomTypesDataTable;
+
+	/** The size of each tile, this needs to match the width and height of the selected tiles */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
+	int32 TileSize;
+
+	/** The minimum number of tiles a room can have */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
+	int32 MinRoomSize;
+
+	/** The maximum number of tiles a room can have */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
+	int32 MaxRoomSize;
+
+	/** The minimum number of tiles a room can have */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
+	int32 MinRoomDistance;
+
+	/** The maximum number of tiles a room can have */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
+	int32 MaxRoomDistance;
+
+	/** The maximum number of rooms to generate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
+	int32 NumberOfRooms;
+
+	/**
+	 * Whether tiles using the same mesh share one InstancedStaticMeshComponent, variants are then only told apart by their CustomData.
+	 * Off by default as it changes which components the tiles end up in
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
+	bool bShareVariantComponents;
+
+	/**
+	 * Whether a tile is dropped when the same mesh was already placed at the same location and rotation.
+	 * Only happens when a tile set lists a mesh more than once, such as a wall mesh that is also one of its wall additions.
+	 * Off by default as it sorts every tile each generation
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Config")
+	bool bCullTileInstances;
+
+	/** The tiles to be used for each section of the rooms */
+	TArray<FRandomTile> RoomFloorTiles;
+	TArray<FRandomTile> RoomWallTiles;
+	TArray<FRandomTile> RoomWallAdditionTiles;
+	TArray<FRandomTile> RoomCeilingTiles;
+	TArray<FRandomTile> RoomDoorTiles;
+	TArray<FRandomTile> RoomDoorAdditionTiles;
+
+	/** The meshes to be used as the floor tiles in the corridors */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Corridors")
+	TArray<FRandomTile> CorridorFloorTileMeshes;
+
+	/** The meshes to be used as the wall tiles in the corridors */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Corridors")
+	TArray<FRandomTile> CorridorWallTileMeshes;
+
+	/** The meshes to be used as the ceiling tiles in the corridors */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Corridors")
+	TArray<FRandomTile> CorridorCeilingTileMeshes;
+
+	/**
+	 * Whether rooms can be placed without lining up with the room they connect to, the corridors between them are routed with bends.
+	 * Off by default as it changes where rooms are placed, so a seed gives a different dungeon with it on
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Corridors")
+	bool bRouteCorridors;
+
+	/** The chance of each pair of neighbouring rooms that aren't already connected getting an extra corridor to create loops, 0 keeps the dungeon a tree */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Corridors", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float LoopConnectionRatio;
+
+	/** The maximum number of tiles between two rooms for them to be given an extra corridor */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Corridors")
+	int32 MaxLoopCorridorLength;
+
+	/** The tiles to be used for each section of the corridors */
+	TArray<FRandomTile> CorridorFloorTiles;
+	TArray<FRandomTile> CorridorWallTiles;
+	TArray<FRandomTile> CorridorCeilingTiles;
+	
+	/**
+	 * Whether the tiles have no collision of their own, instead merged boxes are made for each floor, wall run and corridor.
+	 * Off by default as the boxes don't follow the shape of the tile meshes
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Collision")
+	bool bUseSimplifiedCollision;
+
+	/** The thickness of the simplified floor and wall collision */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Collision", meta = (EditCondition = "bUseSimplifiedCollision"))
+	float CollisionThickness;
+
+	/** The collision profile given to the simplified collision */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Collision", meta = (EditCondition = "bUseSimplifiedCollision"))
+	FName CollisionProfileName;
+
+	/** Whether each room gets a simplified mesh of its floor, walls and ceiling that is drawn instead of its tiles from far away */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | LOD")
+	bool bUseRoomProxies;
+
+	/** The distance from the camera to a room where it swaps from its tiles to its proxy mesh */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | LOD", meta = (EditCondition = "bUseRoomProxies", ClampMin = "0.0"))
+	float RoomProxyDistance;
+
+	/** Whether the tiles are used when building the navmesh, turn off when AI only uses the dungeon's own navigation data */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon | Navigation")
+	bool bTilesAffectNavigation;
+
+	/** The number of duplicate tile instances removed before they were added in the last generation */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Dungeon | Stats")
+	int32 NumCulledInstances;
+
+	/** The text to use for the FRandomStream */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dungeon | Stream")
+	int32 StreamInput;
+
+	/** Increase whenever the generation settings or room types change, clients on a different version are sent the server's layout */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dungeon | Network", meta = (ClampMin = "0"))
+	int32 ConfigVersion;
+
+	/**
+	 * Whether the layout is generated on a worker thread by the FDungeonGenerationService, the dungeon is spawned once it's ready.
+	 * Off by default as the dungeon then no longer exists as soon as BeginPlay returns
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dungeon | Config")
+	bool bGenerateAsync;
+
+	/** Whether the server checks the seed against the Budget before generating, trying the following seeds if it's over */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dungeon | Budget")
+	bool bEnforceBudget;
+
+	/** The most the dungeon is allowed to cost */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dungeon | Budget", meta = (EditCondition = "bEnforceBudget"))
+	FDungeonBudget Budget;
+
+	/** The number of seeds estimated before giving up and using the cheapest, the layouts of the seeds are generated side by side */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dungeon | Budget", meta = (EditCondition = "bEnforceBudget", ClampMin = "1"))
+	int32 MaxBudgetSeedAttempts;
+
+#if WITH_EDITORONLY_DATA
+	/** Whether the dungeon is regenerated in the editor whenever its properties or room types change */
+	UPROPERTY(EditAnywhere, Category = "Dungeon | Editor")
+	bool bPreviewInEditor;
+
+	/** The seconds to wait after the last change before regenerating the preview, so dragging a value only regenerates once it stops */
+	UPROPERTY(EditAnywhere, Category = "Dungeon | Editor", meta = (EditCondition = "bPreviewInEditor", ClampMin = "0.0"))
+	float PreviewDelay;
+#endif
+
+	/** The estimate of the seed the server picked */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Dungeon | Stats")
+	FDungeonBudgetEstimate LastBudgetEstimate;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/** Returns true once the layout has been generated or received from the server */
+	FORCEINLINE bool HasGeneratedLayout() const { return bLayoutGenerated; }
+
+	/** Returns a hash of the rooms, corridors and stream state after the layout stage */
+	FORCEINLINE uint32 GetLayoutHash() const { return Layout->LayoutHash; }
+
+	/** Returns the rooms and corridors of the last generated dungeon */
+	FORCEINLINE const FDungeonLayout& GetLayout() const { return *Layout; }
+
+	/** Writes the layout to a compressed snapshot that can be sent to a client */
+	void BuildLayoutSnapshot(TArray<uint8>& OutSnapshot) const;
+
+	/** Replaces the dungeon with the layout in the snapshot and spawns it */
+	bool ApplyLayoutSnapshot(const TArray<uint8>& Snapshot);
+
+	/** Finds the shortest route from one room to another, OutPortals is filled with each corridor to take in order */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Navigation")
+	bool FindRoomPath(int32 StartRoomIndex, int32 GoalRoomIndex, TArray<FDungeonPortal>& OutPortals) const;
+
+	/** Returns every corridor leading out of the room */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Navigation")
+	TArray<FDungeonPortal> GetRoomPortals(int32 RoomIndex) const;
+
+	/** Returns true if the location is above a room or corridor tile */
+	UFUNCTION(BlueprintPure, Category = "Dungeon | Navigation")
+	bool IsLocationWalkable(const FVector& WorldLocation) const;
+
+	/** Returns the number of rooms in the dungeon */
+	UFUNCTION(BlueprintPure, Category = "Dungeon | Queries")
+	FORCEINLINE int32 GetNumRooms() const { return Rooms.Num(); }
+
+	/** Returns the number of separate corridor networks in the dungeon, corridors that cross are part of the same network */
+	UFUNCTION(BlueprintPure, Category = "Dungeon | Queries")
+	FORCEINLINE int32 GetNumCorridors() const { return Layout->NumCorridors; }
+
+	/** Finds the room containing the location, returns false if it isn't inside a room */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Queries")
+	bool GetRoomAtLocation(const FVector& WorldLocation, int32& OutRoomIndex) const;
+
+	/** Finds the corridor network containing the location, returns false if it isn't inside a corridor */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Queries")
+	bool GetCorridorAtLocation(const FVector& WorldLocation, int32& OutCorridorIndex) const;
+
+	/** Fills OutRoomIndexes with every room with at least one tile inside the box, the array is reset first so callers can reuse it */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Queries")
+	void GetRoomsInBox(const FBox& WorldBox, TArray<int32>& OutRoomIndexes) const;
+
+	/** Fills OutRoomIndexes with the rooms that can be reached from the room by following a single corridor, the array is reset first */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Queries")
+	void GetNeighbouringRooms(int32 RoomIndex, TArray<int32>& OutRoomIndexes) const;
+
+	/** Returns the world space bounds of the room's floor */
+	UFUNCTION(BlueprintPure, Category = "Dungeon | Queries")
+	FBox GetRoomBounds(int32 RoomIndex) const;
+
+	/** Returns the walkability grid and portal graph built from the last generated dungeon */
+	FORCEINLINE const FDungeonNavigationData& GetNavigationData() const { return Layout->NavigationData; }
+
+	/** Returns every spawn point scattered over the rooms, in world space */
+	UFUNCTION(BlueprintPure, Category = "Dungeon | Population")
+	FORCEINLINE TArray<FVector> GetSpawnPoints() const { return SpawnPoints; }
+
+	/** Returns the spawn points scattered over the room, in world space */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Population")
+	TArray<FVector> GetRoomSpawnPoints(int32 RoomIndex) const;
+
+	/** Estimates what the dungeon would cost to spawn from the seed, only the layout is generated */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Budget")
+	FDungeonBudgetEstimate EstimateBudget(int32 Seed);
+
+	/** Works out the expected instances, lights, components and memory of spawning the layout with the current room types */
+	FDungeonBudgetEstimate EstimateLayoutBudget(const FDungeonLayout& EstimatedLayout) const;
+
+	/** Returns the minimap with a texel per tile, see FDungeonLayout::MinimapPixels for what each channel holds. Null on a dedicated server */
+	UFUNCTION(BlueprintPure, Category = "Dungeon | Minimap")
+	FORCEINLINE UTexture2D* GetMinimapTexture() const { return MinimapTexture; }
+
+	/** Returns where the location is on the minimap texture, 0 to 1 along each axis */
+	UFUNCTION(BlueprintPure, Category = "Dungeon | Minimap")
+	FVector2D GetMinimapUV(const FVector& WorldLocation) const;
+
+	/** Clears the fog of war from every tile within Radius tiles of the location */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Minimap")
+	void RevealAroundLocation(const FVector& WorldLocation, int32 Radius);
+
+	/** Clears the fog of war from every tile of the room */
+	UFUNCTION(BlueprintCallable, Category = "Dungeon | Minimap")
+	void RevealRoom(int32 RoomIndex);
+
+private:
+
+	/** The seed replicated to clients so they can generate the dungeon locally */
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedSeed)
+	FDungeonSeed ReplicatedSeed;
+
+	/** The generated rooms */
+	UPROPERTY(Transient)
+	TArray<URoom*> Rooms;
+
+	/** Rooms from earlier generations waiting to be reused */
+	UPROPERTY(Transient)
+	TArray<URoom*> RoomPool;
+
+	/** The amount the dungeon has been moved to align with the starting area */
+	FVector DungeonOffset;
+
+	/** The location of the actor before the dungeon was moved to the starting area */
+	FVector DungeonStartLocation;
+
+	/** The components created for the tiles, destroyed when the dungeon is regenerated */
+	UPROPERTY(Transient)
+	TArray<UInstancedStaticMeshComponent*> TileComponents;
+
+	/** The simplified collision boxes, destroyed when the dungeon is regenerated */
+	UPROPERTY(Transient)
+	TArray<class UBoxComponent*> CollisionComponents;
+
+	/** The simplified room meshes drawn from far away, destroyed when the dungeon is regenerated */
+	UPROPERTY(Transient)
+	TArray<class UProceduralMeshComponent*> RoomProxyComponents;
+
+	/** The proxy of the room being spawned, its tile components are attached to it */
+	UPROPERTY(Transient)
+	class UProceduralMeshComponent* CurrentRoomProxy;
+
+	/** The floor, wall and ceiling sections of the proxy being built */
+	FRoomProxySection RoomProxySections[3];
+
+	/** The component holding every prop and template instance of each mesh, the components are also in the TileComponents */
+	TMap<UStaticMesh*, UInstancedStaticMeshComponent*> PropComponents;
+
+	/** The props and spawn points of each room, kept between generations so the arrays are reused */
+	TArray<FRoomPopulation> RoomPopulations;
+
+	/** The spawn points of every room in world space, RoomSpawnPointStarts has an entry per room plus one for the end */
+	TArray<FVector> SpawnPoints;
+	TArray<int32> RoomSpawnPointStarts;
+
+	/** The minimap of the current dungeon, kept between generations when the size doesn't change */
+	UPROPERTY(Transient)
+	class UTexture2D* MinimapTexture;
+
+	/** The texels of the MinimapTexture with the fog of war cleared so far, changed regions are copied to the texture */
+	TArray<FColor> MinimapPixels;
+
+	/** The actors spawned in the dungeon, destroyed when the dungeon is regenerated */
+	UPROPERTY(Transient)
+	TArray<AActor*> SpawnedActors;
+
+	/** The rooms and corridors being spawned, shared with whoever generated it and never changed */
+	FDungeonLayoutPtr Layout;
+
+	/** Whether the layout stage has finished */
+	bool bLayoutGenerated;
+
+	/** Whether the dungeon is an editor preview, previews are drawn from the actor without moving it and don't spawn actors */
+	bool bIsPreview;
+
+#if WITH_EDITOR
+	/** Restarted by every change so the preview is only regenerated once the changes stop */
+	FTimerHandle PreviewTimerHandle;
+
+	/** Whether any of the changes since the last preview affect the layout, otherwise the layout is reused */
+	bool bPreviewNeedsLayout;
+
+	/** The room types table being watched for changes */
+	TWeakObjectPtr<UDataTable> WatchedRoomTypes;
+	FDelegateHandle RoomTypesChangedHandle;
+#endif
+
+	/** Increased for every layout asked for, layouts that finish generating after a newer one was asked for are dropped */
+	int32 LayoutRequestId;
+
+	/** Set to stop the layout being generated on a worker thread once it is no longer wanted */
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> PendingLayoutCancelFlag;
+
+	/** Generates the layout when it isn't generated asynchronously */
+	FDungeonLayoutGenerator LayoutGenerator;
+
+	/** Every tile spawned this generation, added to the InstancedStaticMeshComponents by SubmitTileInstances */
+	TArray<FPendingTileInstance> PendingTileInstances;
+
+	/** The custom data of every pending tile, stored together to avoid an allocation per tile */
+	TArray<float> PendingCustomData;
+
+	/** The sorted keys of the pending tiles and which of them are culled, kept between generations so culling doesn't allocate */
+	TArray<FTileInstanceKey> PendingTileKeys;
+	TArray<bool> IsDuplicateTile;
+
+	/** The row names of the RoomTypesDataTable, gathered once per generation */
+	TArray<FName> RoomTypeRowNames;
+	TArray<FRoomType*> RoomTypeRows;
+
+	/** The transforms of the template mesh being stamped, kept to avoid reallocating for every mesh */
+	TArray<FTransform> TemplateTransforms;
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+private:
+
+	/** Generates the dungeon on the client once the server's seed arrives */
+	UFUNCTION()
+	void OnRep_ReplicatedSeed();
+
+	/** Generates the dungeon from the replicated seed and sends the layout hash to the server */
+	void GenerateFromReplicatedSeed();
+
+#if WITH_EDITOR
+	/** Regenerates the preview after the PreviewDelay, bRegenerateLayout is false when only the spawning needs to be redone */
+	void SchedulePreview(bool bRegenerateLayout);
+
+	/** Regenerates the preview, the layout is generated by the FDungeonGenerationService and spawned once it arrives */
+	void UpdatePreview();
+
+	/** Keeps the preview up to date with edits made to the RoomTypesDataTable */
+	void WatchRoomTypes();
+	void OnRoomTypesChanged();
+#endif
+
+	/** Generates a new layout from the stream, then replaces any existing dungeon with it */
+	void GenerateDungeon();
+
+	/** Drops any layout still being generated and stops its worker early, returns the id of the next layout request */
+	int32 CancelPendingLayout();
+
+	/** Copies the generation settings for the layout stage */
+	FDungeonLayoutSettings MakeLayoutSettings() const;
+
+	/** Replaces the dungeon with the newly generated layout and spawns it, clients then report the layout to the server */
+	void OnLayoutGenerated(FDungeonLayoutRef NewLayout);
+
+	/** Creates the rooms for the layout, moves the dungeon to the starting area and continues the stream from where the layout finished */
+	void ApplyLayout(FDungeonLayoutRef NewLayout);
+
+	/** Spawns the tiles and lights for the generated layout */
+	void SpawnDungeon();
+
+	/** Destroys everything spawned for the dungeon and forgets the layout */
+	void ClearDungeon();
+
+	/** Returns a cleared room from the RoomPool, only creating a new one when the pool is empty */
+	URoom* AcquireRoom();
+
+	/** Adds the Tile to the PendingTileInstances along with its custom data */
+	void QueueTileInstance(const FRandomTile& Tile, const FTransform& AtLocation);
+
+	/** Spawns a random tile from the TilesArray at the AtLocation*/
+	void SpawnRandomTile(const TArray<FRandomTile>& InstancedTileMeshesArray, const FTransform& AtLocation);
+
+	/** Spawns a random tile from the TilesArray at the AtLocation*/
+	void SpawnAllTiles(const TArray<FRandomTile>& InstancedTileMeshesArray, const FTransform& AtLocation, const int32 CurrentHeight);
+
+	/** Adds the PendingTileInstances to their InstancedStaticMeshComponents, removing the duplicates first when bCullTileInstances is set */
+	void SubmitTileInstances();
+
+	/** Refreshes the components with custom data and empties the PendingTileInstances once they have all been added */
+	void FinishSubmittingTileInstances();
+
+	/** Adds a single pending tile and its custom data to its InstancedStaticMeshComponent */
+	void AddPendingTileInstance(const FPendingTileInstance& Instance);
+
+	/** Scatters the props and spawn points of every room's type, the rooms are sampled in parallel with a stream each */
+	void PopulateRooms();
+
+	/** Samples the props and spawn points of a single room, safe to call from any thread */
+	static void PopulateRoom(URoom* Room, FRoomPopulation& Population);
+
+	/** Returns true if the room type can be used for a room covering RoomRect, room types with a template have to fit the room's size and doors */
+	static bool CanUseRoomType(const FIntRect& RoomRect, TArrayView<const FIntPoint> DoorLocations, const FRoomType& RoomType);
+
+	/** Estimates the seeds following the stream's seed until one is within the Budget, then starts the stream from it */
+	void SelectSeedWithinBudget();
+
+	/** Adds the template's instances to the dungeon with the room's position added to each */
+	void StampRoomTemplate(URoom* Room, const URoomTemplate* Template);
+
+	/** Returns the component shared by every prop and template instance of the mesh, creating it the first time the mesh is used */
+	UInstancedStaticMeshComponent* GetPropComponent(UStaticMesh* Mesh);
+
+	/** Copies the layout's minimap into the MinimapTexture, everything starts hidden */
+	void CreateMinimapTexture();
+
+	/**
+	 * Reveals the tiles in TileRect (Max is exclusive) that are within Radius tiles of Centre, or all of them if Radius is INDEX_NONE.
+	 * Only the texels that changed are sent to the texture.
+	 */
+	void RevealMinimapTiles(FIntRect TileRect, const FIntPoint& Centre, int32 Radius);
+
+	/** Creates merged collision boxes for the floors and wall runs of the rooms and corridors */
+	void SpawnSimplifiedCollision();
+
+	/** Returns true if there is a wall on the Side of the tile that needs collision, and the range of tile heights it covers */
+	bool GetWallCollision(const FIntPoint& Tile, EDungeonDirection Side, int32& OutMinHeight, int32& OutMaxHeight);
+
+	/** Creates a collision box covering Min to Max, in the actor's space */
+	void AddCollisionBox(const FVector& Min, const FVector& Max);
+
+	/** Loops through the Rooms array and spawns the tiles */
+	void SpawnRooms();
+
+	/** Creates arrays of InstancedStaticMeshes from the SelectedRoomType to be spawned */
+	void CreateInstancedStaticMeshesForCurrentRoom(FRoomType*& SelectedRoomType);
+
+	/**
+	 * Builds the proxy mesh of a room and makes it the CurrentRoomProxy, one quad for the floor and ceiling and a few per wall
+	 * leaving gaps for the doors. Uses the material of the first floor, wall and ceiling mesh of the room type. Returns the number of triangles.
+	 */
+	int32 CreateRoomProxy(URoom* Room, const FRoomType* RoomType);
+
+	/** Randomly selects a row from the RoomTypes DataTable and applies it to the CurrentRoom  */
+	FRoomType* PickRandomRoomTypeForRoom(URoom*& CurrentRoom);
+
+	/** Spawn floor, wall and ceiling tiles for every corridor tile in the TileGrid */
+	void SpawnCorridorTiles();
+
+	/** Spawn walls for the passed in URoom */
+	void SpawnRoomWalls(URoom*& Room);
+
+	/** Spawns wall and door tiles from the StartPoint to the EndPoint with the Rotation */
+	void SpawnWall(FIntPoint& StartPoint, FIntPoint& EndPoint, FRotator& Rotation, const int32& Height, const TArray<FIntPoint>& DoorLocations);
+
+	/** Create InstancedStaticMeshComponent from the Meshes passed in */
+	void CreateInstancedStaticMeshComponents(const TArray<FRandomTile>& TileMeshes, TArray<FRandomTile>& InstancedTileMeshes);
+
+	/** Returns the tile under the WorldLocation */
+	FIntPoint WorldToTile(const FVector& WorldLocation) const;
+
+	/** Returns the world location of the centre of the edge between two neighbouring tiles */
+	FVector GetDoorwayLocation(const FIntPoint& TileA, const FIntPoint& TileB) const;
+
+	/** Converts a link in the NavigationData into a portal */
+	FDungeonPortal MakePortal(const FDungeonNavLink& Link) const;
+
+	/** Spawns light sources in all rooms */
+	void SpawnLightsInRooms();
+
+	/** Spawns as many lights as possible from StartLocation to EndLocation with at least the GapBetweenLights between them */
+	void SpawnLightsAlongLength(FVector StartLocation, FVector EndLocation, FRotator Rotation, int32 GapBetweenLights, TSubclassOf<AActor> ActorToSpawn);
+};
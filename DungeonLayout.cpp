@@ -0,0 +1,571 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonLayout.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Crc.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDungeonLayout, Log, All);
+
+/** Below this many tiles the minimap is quicker to fill on one thread than to spread out */
+static const int32 MinTilesToRasterizeInParallel = 16384;
+
+bool FDungeonLayoutRoom::CanPack(const FIntPoint& Position, const FIntPoint& Size)
+{
+	// The far corner has to fit too so the room's max and its door pivots can be packed
+	return Position.X >= MIN_int16 && Position.Y >= MIN_int16 && Size.X >= 0 && Size.Y >= 0
+		&& Position.X + Size.X <= MAX_int16 && Position.Y + Size.Y <= MAX_int16;
+}
+
+FDungeonLayoutRoom FDungeonLayoutRoom::Pack(const FIntPoint& Position, const FIntPoint& Size)
+{
+	check(CanPack(Position, Size));
+
+	FDungeonLayoutRoom Room;
+	Room.X = static_cast<int16>(Position.X);
+	Room.Y = static_cast<int16>(Position.Y);
+	Room.SizeX = static_cast<int16>(Size.X);
+	Room.SizeY = static_cast<int16>(Size.Y);
+	return Room;
+}
+
+TSharedRef<FDungeonLayout, ESPMode::ThreadSafe> FDungeonLayoutGenerator::Generate(const FDungeonLayoutSettings& Settings)
+{
+	// Everything temporary made while generating comes off this thread's FMemStack and is freed in one go when this returns
+	FMemMark GenerationMark(FMemStack::Get());
+
+	TSharedRef<FDungeonLayout, ESPMode::ThreadSafe> NewLayout = MakeShared<FDungeonLayout, ESPMode::ThreadSafe>();
+	NewLayout->Settings = Settings;
+	NewLayout->Rooms.Reserve(Settings.NumberOfRooms);
+
+	Layout = &NewLayout.Get();
+	Stream.Initialize(Settings.Seed);
+
+	// Create array of rooms that can be placed in the world
+	while (Layout->Rooms.Num() < Settings.NumberOfRooms && !Settings.IsCancelled())
+	{
+		TryPlaceRoom();
+	}
+
+	// Whoever cancelled has already moved on to a newer layout, so skip the remaining stages
+	if (!Settings.IsCancelled())
+	{
+		AddStartArea(*Layout);
+
+		BuildTileGrid();
+		AddLoopConnections();
+	}
+
+	if (!Settings.IsCancelled())
+	{
+		CreateCorridors();
+	}
+
+	if (!Settings.IsCancelled())
+	{
+		FinishLayout(*Layout, Stream.GetCurrentSeed());
+	}
+
+	Layout = nullptr;
+
+	return NewLayout;
+}
+
+void FDungeonLayoutGenerator::AddStartArea(FDungeonLayout& Layout)
+{
+	if (Layout.Rooms.Num() == 0)
+	{
+		return;
+	}
+
+	int32 LowestRoomIndex = 0;
+
+	for (int32 RoomIndex = 1; RoomIndex < Layout.Rooms.Num(); RoomIndex++)
+	{
+		if (Layout.Rooms[RoomIndex].X < Layout.Rooms[LowestRoomIndex].X)
+		{
+			LowestRoomIndex = RoomIndex;
+		}
+	}
+
+	const FDungeonLayoutRoom& LowestRoom = Layout.Rooms[LowestRoomIndex];
+	Layout.StartPoint = FIntPoint(LowestRoom.X, LowestRoom.Y + LowestRoom.SizeY / 2);
+
+	// Add door between the starting area and the first room
+	AddDoor(Layout, LowestRoomIndex, Layout.StartPoint);
+}
+
+void FDungeonLayoutGenerator::AddDoor(FDungeonLayout& Layout, int32 RoomIndex, const FIntPoint& Pivot)
+{
+	// Doors added more than once are removed by FinishLayout, checking here would mean searching every door for each one added
+	FDungeonLayoutDoor& Door = Layout.Doors.AddDefaulted_GetRef();
+	Door.X = static_cast<int16>(Pivot.X);
+	Door.Y = static_cast<int16>(Pivot.Y);
+	Door.RoomIndex = RoomIndex;
+}
+
+void FDungeonLayoutGenerator::FinishLayout(FDungeonLayout& Layout, int32 PostLayoutSeed)
+{
+	// Group the doors by room, sorting by the pivot too puts any door added more than once next to its copy
+	Layout.Doors.Sort([](const FDungeonLayoutDoor& A, const FDungeonLayoutDoor& B)
+	{
+		if (A.RoomIndex != B.RoomIndex)
+			return A.RoomIndex < B.RoomIndex;
+		if (A.X != B.X)
+			return A.X < B.X;
+
+		return A.Y < B.Y;
+	});
+
+	int32 NumUniqueDoors = 0;
+
+	for (int32 DoorIndex = 0; DoorIndex < Layout.Doors.Num(); DoorIndex++)
+	{
+		const FDungeonLayoutDoor& Door = Layout.Doors[DoorIndex];
+
+		if (NumUniqueDoors == 0 || Door.RoomIndex != Layout.Doors[NumUniqueDoors - 1].RoomIndex
+			|| Door.X != Layout.Doors[NumUniqueDoors - 1].X || Door.Y != Layout.Doors[NumUniqueDoors - 1].Y)
+		{
+			Layout.Doors[NumUniqueDoors++] = Door;
+		}
+	}
+
+	Layout.Doors.SetNum(NumUniqueDoors, false);
+
+	Layout.RoomDoorStarts.Reset();
+
+	for (int32 RoomIndex = 0; RoomIndex <= Layout.Rooms.Num(); RoomIndex++)
+	{
+		Layout.RoomDoorStarts.Add(Algo::LowerBoundBy(Layout.Doors, RoomIndex, &FDungeonLayoutDoor::RoomIndex));
+	}
+
+	Layout.NumCorridors = Layout.TileGrid.LabelCorridors();
+	Layout.NavigationData.Build(Layout.TileGrid, Layout.Rooms.Num());
+
+	// Flatten the portal graph into a list of unique neighbours for each room
+	Layout.RoomNeighbourStarts.Reset();
+	Layout.RoomNeighbours.Reset();
+
+	for (int32 RoomIndex = 0; RoomIndex < Layout.Rooms.Num(); RoomIndex++)
+	{
+		Layout.RoomNeighbourStarts.Add(Layout.RoomNeighbours.Num());
+
+		for (const FDungeonNavLink& Link : Layout.NavigationData.GetRoomLinks(RoomIndex))
+		{
+			int32 NeighbourIndex = Layout.NavigationData.Doors[Link.ToDoor].RoomIndex;
+			bool AlreadyAdded = false;
+
+			for (int32 i = Layout.RoomNeighbourStarts.Last(); i < Layout.RoomNeighbours.Num() && !AlreadyAdded; i++)
+			{
+				AlreadyAdded = Layout.RoomNeighbours[i] == NeighbourIndex;
+			}
+
+			if (!AlreadyAdded)
+			{
+				Layout.RoomNeighbours.Add(NeighbourIndex);
+			}
+		}
+	}
+
+	Layout.RoomNeighbourStarts.Add(Layout.RoomNeighbours.Num());
+
+	if (Layout.Settings.bRasterizeMinimap)
+	{
+		RasterizeMinimap(Layout);
+	}
+
+	Layout.PostLayoutSeed = PostLayoutSeed;
+	Layout.LayoutHash = ComputeLayoutHash(Layout);
+}
+
+void FDungeonLayoutGenerator::RasterizeMinimap(FDungeonLayout& Layout)
+{
+	const FDungeonTileGrid& TileGrid = Layout.TileGrid;
+	Layout.MinimapPixels.SetNumUninitialized(TileGrid.Num());
+
+	FColor* Pixels = Layout.MinimapPixels.GetData();
+
+	// Every row only writes its own texels so the rows can be filled at the same time
+	ParallelFor(TileGrid.Height, [&TileGrid, Pixels](int32 Row)
+	{
+		for (int32 Column = 0; Column < TileGrid.Width; Column++)
+		{
+			FIntPoint Cell = TileGrid.Origin + FIntPoint(Column, Row);
+			const FDungeonTile& Tile = TileGrid.GetTile(Cell);
+			uint8 WallMask = 0;
+
+			if (Tile.Type != EDungeonTileType::Empty)
+			{
+				for (uint8 Side = 0; Side < 4; Side++)
+				{
+					FIntPoint Neighbour = FDungeonTileGrid::GetNeighbour(Cell, static_cast<EDungeonDirection>(Side));
+					EDungeonTileType NeighbourType = TileGrid.GetTileType(Neighbour);
+					uint8 OppositeSide = static_cast<uint8>(FDungeonTileGrid::GetOpposite(static_cast<EDungeonDirection>(Side)));
+
+					// Rooms only open on to corridors through a door, the door is stored on the corridor tile
+					bool bIsOpen = NeighbourType == Tile.Type
+						|| (Tile.DoorMask & (1 << Side))
+						|| (NeighbourType == EDungeonTileType::Corridor && (TileGrid.GetTile(Neighbour).DoorMask & (1 << OppositeSide)));
+
+					if (!bIsOpen)
+					{
+						WallMask |= 1 << Side;
+					}
+				}
+			}
+
+			uint8 TypeValue = Tile.Type == EDungeonTileType::Room ? 255 : Tile.Type == EDungeonTileType::Corridor ? 128 : 0;
+			Pixels[Row * TileGrid.Width + Column] = FColor(TypeValue, WallMask * 16, 0, 0);
+		}
+	}, TileGrid.Num() < MinTilesToRasterizeInParallel);
+}
+
+uint32 FDungeonLayoutGenerator::ComputeLayoutHash(const FDungeonLayout& Layout)
+{
+	uint32 Hash = FCrc::MemCrc32(&Layout.Settings.ConfigVersion, sizeof(int32));
+
+	// The packed rooms have no padding so they can be hashed in one go
+	Hash = FCrc::MemCrc32(Layout.Rooms.GetData(), Layout.Rooms.Num() * sizeof(FDungeonLayoutRoom), Hash);
+
+	for (const FConnectingRoom& RoomConnection : Layout.RoomConnections)
+	{
+		Hash = FCrc::MemCrc32(&RoomConnection.RoomAIndex, sizeof(int32), Hash);
+		Hash = FCrc::MemCrc32(&RoomConnection.RoomBIndex, sizeof(int32), Hash);
+	}
+
+	const FDungeonTileGrid& TileGrid = Layout.TileGrid;
+
+	Hash = FCrc::MemCrc32(&TileGrid.Origin, sizeof(FIntPoint), Hash);
+	Hash = FCrc::MemCrc32(&TileGrid.Width, sizeof(int32), Hash);
+	Hash = FCrc::MemCrc32(&TileGrid.Height, sizeof(int32), Hash);
+
+	// Carrying the CRC on between blocks gives the same hash as the whole grid packed at once
+	uint8 PackedTiles[1024];
+
+	for (int32 StartIndex = 0; StartIndex < TileGrid.Num(); StartIndex += UE_ARRAY_COUNT(PackedTiles))
+	{
+		int32 Count = FMath::Min<int32>(UE_ARRAY_COUNT(PackedTiles), TileGrid.Num() - StartIndex);
+		TileGrid.PackTiles(StartIndex, Count, PackedTiles);
+		Hash = FCrc::MemCrc32(PackedTiles, Count, Hash);
+	}
+
+	return FCrc::MemCrc32(&Layout.PostLayoutSeed, sizeof(int32), Hash);
+}
+
+void FDungeonLayoutGenerator::TryPlaceRoom()
+{
+	const FDungeonLayoutSettings& Settings = Layout->Settings;
+
+	FIntPoint Size;
+	Size.X = UKismetMathLibrary::RandomIntegerInRangeFromStream(Settings.MinRoomSize, Settings.MaxRoomSize, Stream);
+	Size.Y = UKismetMathLibrary::RandomIntegerInRangeFromStream(Settings.MinRoomSize, Settings.MaxRoomSize, Stream);
+
+	if (Layout->Rooms.Num() == 0)
+	{
+		Layout->Rooms.Add(FDungeonLayoutRoom::Pack(FIntPoint::ZeroValue, Size));
+		return;
+	}
+
+	// Pick a random room to place the NewRoom next to
+	int32 RoomIndexToConnectRoomTo = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, Layout->Rooms.Num() - 1, Stream);
+	const FDungeonLayoutRoom& ConnectingRoom = Layout->Rooms[RoomIndexToConnectRoomTo];
+
+	int32 SpaceBetweenRooms = UKismetMathLibrary::RandomIntegerInRangeFromStream(Settings.MinRoomDistance, Settings.MaxRoomDistance, Stream);
+	int32 RandomPosition = 0;
+	FIntPoint Position = FIntPoint::ZeroValue;
+
+	// Pick a random direction to spawn the room
+	int32 DirectionToPlaceRoom = UKismetMathLibrary::RandomIntegerInRangeFromStream(0, 3, Stream);
+	switch (DirectionToPlaceRoom)
+	{
+	case 0: // Top
+		RandomPosition = GetRandomPointAlongRoom(ConnectingRoom.Y, ConnectingRoom.GetRoomMax().Y, Size.Y);
+		Position = FIntPoint(ConnectingRoom.GetRoomMax().X + SpaceBetweenRooms, RandomPosition);
+		break;
+	case 1: // Right
+		RandomPosition = GetRandomPointAlongRoom(ConnectingRoom.X, ConnectingRoom.GetRoomMax().X, Size.X);
+		Position = FIntPoint(RandomPosition, ConnectingRoom.GetRoomMax().Y + SpaceBetweenRooms);
+		break;
+	case 2: // Bottom
+		RandomPosition = GetRandomPointAlongRoom(ConnectingRoom.Y, ConnectingRoom.GetRoomMax().Y, Size.Y);
+		Position = FIntPoint(ConnectingRoom.X - Size.X - SpaceBetweenRooms, RandomPosition);
+		break;
+	case 3: // Left
+		RandomPosition = GetRandomPointAlongRoom(ConnectingRoom.X, ConnectingRoom.GetRoomMax().X, Size.X);
+		Position = FIntPoint(RandomPosition, ConnectingRoom.Y - Size.Y - SpaceBetweenRooms);
+		break;
+	default:
+		break;
+	}
+
+	// A room that can't be packed is thrown away the same as one that overlaps, so the stream carries on the same either way
+	if (!FDungeonLayoutRoom::CanPack(Position, Size))
+	{
+		return;
+	}
+
+	FDungeonLayoutRoom NewRoom = FDungeonLayoutRoom::Pack(Position, Size);
+
+	if (!IsOverlappingOtherRooms(NewRoom))
+	{
+		FConnectingRoom RoomConnection;
+		RoomConnection.RoomAIndex = RoomIndexToConnectRoomTo;
+		RoomConnection.RoomBIndex = Layout->Rooms.Num();
+
+		Layout->RoomConnections.Add(RoomConnection);
+		Layout->Rooms.Add(NewRoom);
+	}
+}
+
+bool FDungeonLayoutGenerator::IsOverlappingOtherRooms(const FDungeonLayoutRoom& Room) const
+{
+	const FDungeonLayoutRoom* PlacedRooms = Layout->Rooms.GetData();
+	const int32 NumPlacedRooms = Layout->Rooms.Num();
+	const int32 RoomMaxX = Room.X + Room.SizeX;
+	const int32 RoomMaxY = Room.Y + Room.SizeY;
+
+	// No early out or branches so the compiler can test several of the packed rooms at once
+	int32 NumOverlapping = 0;
+
+	for (int32 RoomIndex = 0; RoomIndex < NumPlacedRooms; RoomIndex++)
+	{
+		const FDungeonLayoutRoom& CurrentRoom = PlacedRooms[RoomIndex];
+
+		// Check if the two rooms overlap on the X
+		int32 X1 = FMath::Max<int32>(CurrentRoom.X, Room.X);
+		int32 X2 = FMath::Min<int32>(CurrentRoom.X + CurrentRoom.SizeX, RoomMaxX);
+
+		// Check if the two rooms overlap on the Y
+		int32 Y1 = FMath::Max<int32>(CurrentRoom.Y, Room.Y);
+		int32 Y2 = FMath::Min<int32>(CurrentRoom.Y + CurrentRoom.SizeY, RoomMaxY);
+
+		// If they overlap on both the X and the Y then the rooms are overlapping
+		NumOverlapping += (X1 <= X2) & (Y1 <= Y2);
+	}
+
+	return NumOverlapping > 0;
+}
+
+void FDungeonLayoutGenerator::BuildTileGrid()
+{
+	FIntPoint Min(MAX_int32, MAX_int32);
+	FIntPoint Max(MIN_int32, MIN_int32);
+
+	for (const FDungeonLayoutRoom& Room : Layout->Rooms)
+	{
+		FIntRect RoomRect = Room.GetRoomRect();
+		Min = FIntPoint(FMath::Min(Min.X, RoomRect.Min.X), FMath::Min(Min.Y, RoomRect.Min.Y));
+		Max = FIntPoint(FMath::Max(Max.X, RoomRect.Max.X), FMath::Max(Max.Y, RoomRect.Max.Y));
+	}
+
+	// Leave space around the rooms for corridors to go around them, apart from below the lowest room where the starting area is
+	const int32 CorridorMargin = 2;
+	Layout->TileGrid.Initialize(FIntPoint(Min.X, Min.Y - CorridorMargin), Max + FIntPoint(CorridorMargin, CorridorMargin));
+
+	for (int32 RoomIndex = 0; RoomIndex < Layout->Rooms.Num(); RoomIndex++)
+	{
+		FIntRect RoomRect = Layout->Rooms[RoomIndex].GetRoomRect();
+		Layout->TileGrid.MarkRoom(RoomRect.Min, RoomRect.Size(), RoomIndex);
+	}
+}
+
+void FDungeonLayoutGenerator::AddLoopConnections()
+{
+	if (Layout->Settings.LoopConnectionRatio <= 0.f || Layout->Rooms.Num() < 3)
+	{
+		return;
+	}
+
+	TDungeonScratchArray<FRoomAdjacency> Neighbours;
+	Layout->TileGrid.FindNeighbouringRooms(Layout->Settings.MaxLoopCorridorLength, Neighbours);
+
+	// Sorted so the rooms already connected can be binary searched
+	TDungeonScratchArray<uint64> ConnectedRooms;
+	ConnectedRooms.Reserve(Layout->RoomConnections.Num());
+
+	for (const FConnectingRoom& RoomConnection : Layout->RoomConnections)
+	{
+		ConnectedRooms.Add(FRoomAdjacency::MakeKey(RoomConnection.RoomAIndex, RoomConnection.RoomBIndex));
+	}
+
+	ConnectedRooms.Sort();
+
+	// Try the closest rooms first, ties are broken by index so the result only depends on the stream
+	Neighbours.Sort([](const FRoomAdjacency& A, const FRoomAdjacency& B)
+	{
+		if (A.Distance != B.Distance)
+			return A.Distance < B.Distance;
+
+		return FRoomAdjacency::MakeKey(A.RoomAIndex, A.RoomBIndex) < FRoomAdjacency::MakeKey(B.RoomAIndex, B.RoomBIndex);
+	});
+
+	for (const FRoomAdjacency& Neighbour : Neighbours)
+	{
+		if (Algo::BinarySearch(ConnectedRooms, FRoomAdjacency::MakeKey(Neighbour.RoomAIndex, Neighbour.RoomBIndex)) != INDEX_NONE)
+		{
+			continue;
+		}
+
+		if (UKismetMathLibrary::RandomBoolWithWeightFromStream(Layout->Settings.LoopConnectionRatio, Stream))
+		{
+			FConnectingRoom RoomConnection;
+			RoomConnection.RoomAIndex = Neighbour.RoomAIndex;
+			RoomConnection.RoomBIndex = Neighbour.RoomBIndex;
+
+			Layout->RoomConnections.Add(RoomConnection);
+		}
+	}
+}
+
+void FDungeonLayoutGenerator::CreateCorridors()
+{
+	// Loop through the connecting rooms
+	for (const FConnectingRoom& RoomConnection : Layout->RoomConnections)
+	{
+		// Get the two connecting rooms by their index
+		const FDungeonLayoutRoom& RoomA = Layout->Rooms[RoomConnection.RoomAIndex];
+		const FDungeonLayoutRoom& RoomB = Layout->Rooms[RoomConnection.RoomBIndex];
+
+		// Find the min and max of the room positions and Maximums to calculate where the rooms are in
+		int32 MaxOriginX = FMath::Max<int32>(RoomA.X, RoomB.X);
+		int32 MinMaximumX = FMath::Min(RoomA.GetRoomMax().X, RoomB.GetRoomMax().X);
+
+		int32 MaxOriginY = FMath::Max<int32>(RoomA.Y, RoomB.Y);
+		int32 MinMaximumY = FMath::Min(RoomA.GetRoomMax().Y, RoomB.GetRoomMax().Y);
+
+		bool CorridorAdded = false;
+
+		// Check if rooms are next to each other on the Y axis
+		if (MaxOriginX < MinMaximumX && MaxOriginY > MinMaximumY)
+		{
+			// Check which room is on the right on the Y axis
+			bool RoomBIsRight = RoomB.Y > RoomA.GetRoomMax().Y;
+			int32 LeftRoom = RoomBIsRight ? RoomConnection.RoomAIndex : RoomConnection.RoomBIndex;
+			int32 RightRoom = RoomBIsRight ? RoomConnection.RoomBIndex : RoomConnection.RoomAIndex;
+
+			// Pick the random point between the points the rooms overlap on the X
+			int32 CorridorX = UKismetMathLibrary::RandomIntegerInRangeFromStream(MaxOriginX, MinMaximumX - 1, Stream);
+
+			// Corridor will go from the right side of the left room to the right room at the random point on the X
+			FIntPoint CorridorStart = FIntPoint(CorridorX, Layout->Rooms[LeftRoom].GetRoomMax().Y);
+			FIntPoint CorridorEnd = FIntPoint(CorridorX, Layout->Rooms[RightRoom].Y);
+
+			CorridorAdded = AddStraightCorridor(CorridorStart, CorridorEnd, LeftRoom, RightRoom);
+		}
+		// else check if rooms are next to each other on the X axis
+		else if (MaxOriginY < MinMaximumY && MaxOriginX > MinMaximumX)
+		{
+			// Check which room is higher on the X axis
+			bool RoomBIsTop = RoomB.X > RoomA.GetRoomMax().X;
+			int32 TopRoom = RoomBIsTop ? RoomConnection.RoomBIndex : RoomConnection.RoomAIndex;
+			int32 BottomRoom = RoomBIsTop ? RoomConnection.RoomAIndex : RoomConnection.RoomBIndex;
+
+			// Pick the random point between the points the rooms overlap on the Y
+			int32 CorridorY = UKismetMathLibrary::RandomIntegerInRangeFromStream(MaxOriginY, MinMaximumY - 1, Stream);
+
+			// Corridor will go from the top of the bottom room to the top room at the random point on the Y
+			FIntPoint CorridorStart = FIntPoint(Layout->Rooms[BottomRoom].GetRoomMax().X, CorridorY);
+			FIntPoint CorridorEnd = FIntPoint(Layout->Rooms[TopRoom].X, CorridorY);
+
+			CorridorAdded = AddStraightCorridor(CorridorStart, CorridorEnd, BottomRoom, TopRoom);
+		}
+
+		// Rooms that don't line up, or have a room in the way, need a corridor with bends
+		if (!CorridorAdded)
+		{
+			if (CorridorRouter.FindPath(Layout->TileGrid, RoomA.GetRoomRect(), RoomB.GetRoomRect(), CorridorPath))
+			{
+				AddCorridorPath(CorridorPath, RoomConnection.RoomAIndex, RoomConnection.RoomBIndex);
+			}
+			else
+			{
+				UE_LOG(LogDungeonLayout, Warning, TEXT("Unable to route a corridor between room %d and room %d"), RoomConnection.RoomAIndex, RoomConnection.RoomBIndex);
+			}
+		}
+	}
+}
+
+bool FDungeonLayoutGenerator::AddStraightCorridor(const FIntPoint& CorridorStart, const FIntPoint& CorridorEnd, int32 StartRoom, int32 EndRoom)
+{
+	FIntPoint Step = CorridorStart.X == CorridorEnd.X ? FIntPoint(0, 1) : FIntPoint(1, 0);
+
+	// The corridor is straight so only one of the two differences isn't zero
+	int32 NumberOfTiles = FMath::Max(FMath::Abs(CorridorEnd.X - CorridorStart.X) + FMath::Abs(CorridorEnd.Y - CorridorStart.Y), 1);
+
+	CorridorPath.Reset();
+
+	for (int32 i = 0; i < NumberOfTiles; i++)
+	{
+		FIntPoint Tile = CorridorStart + Step * i;
+
+		// Leave it to the router to go around anything in the way
+		if (Layout->TileGrid.GetTileType(Tile) == EDungeonTileType::Room)
+		{
+			return false;
+		}
+
+		CorridorPath.Add(Tile);
+	}
+
+	AddCorridorPath(CorridorPath, StartRoom, EndRoom);
+
+	return true;
+}
+
+void FDungeonLayoutGenerator::AddCorridorPath(const TArray<FIntPoint>& Path, int32 StartRoom, int32 EndRoom)
+{
+	if (Path.Num() == 0)
+	{
+		return;
+	}
+
+	for (const FIntPoint& Tile : Path)
+	{
+		Layout->TileGrid.GetTile(Tile).Type = EDungeonTileType::Corridor;
+	}
+
+	AddCorridorDoor(Path[0], StartRoom);
+	AddCorridorDoor(Path.Last(), EndRoom);
+}
+
+void FDungeonLayoutGenerator::AddCorridorDoor(const FIntPoint& Cell, int32 RoomIndex)
+{
+	FDungeonTileGrid& TileGrid = Layout->TileGrid;
+
+	for (uint8 Side = 0; Side < 4; Side++)
+	{
+		FIntPoint Neighbour = FDungeonTileGrid::GetNeighbour(Cell, static_cast<EDungeonDirection>(Side));
+
+		if (TileGrid.GetTileType(Neighbour) == EDungeonTileType::Room && TileGrid.GetTile(Neighbour).RoomIndex == RoomIndex)
+		{
+			TileGrid.GetTile(Cell).DoorMask |= 1 << Side;
+
+			// The room's wall on this edge faces the other way so use the pivot from the room's side
+			FIntPoint DoorPivot = FDungeonTileGrid::GetWallPivot(Neighbour, FDungeonTileGrid::GetOpposite(static_cast<EDungeonDirection>(Side)));
+			AddDoor(*Layout, RoomIndex, DoorPivot);
+			return;
+		}
+	}
+}
+
+int32 FDungeonLayoutGenerator::GetRandomPointWhereRoomsOverlap(int32 ConnectingRoomPosition, int32 ConnectingRoomExtent, int32 NewRoomSize)
+{
+	int32 MinYPosition = (ConnectingRoomPosition - NewRoomSize) + 1;
+	int32 MaxYPosition = ConnectingRoomExtent - 1;
+	return UKismetMathLibrary::RandomIntegerInRangeFromStream(MinYPosition, MaxYPosition, Stream);
+}
+
+int32 FDungeonLayoutGenerator::GetRandomPointAlongRoom(int32 ConnectingRoomPosition, int32 ConnectingRoomExtent, int32 NewRoomSize)
+{
+	if (!Layout->Settings.bRouteCorridors)
+	{
+		return GetRandomPointWhereRoomsOverlap(ConnectingRoomPosition, ConnectingRoomExtent, NewRoomSize);
+	}
+
+	// Corridors can bend so the room can be anywhere within MaxRoomDistance of either end of the connecting room
+	int32 MinPosition = (ConnectingRoomPosition - NewRoomSize) - Layout->Settings.MaxRoomDistance;
+	int32 MaxPosition = ConnectingRoomExtent + Layout->Settings.MaxRoomDistance;
+	return UKismetMathLibrary::RandomIntegerInRangeFromStream(MinPosition, MaxPosition, Stream);
+}
@@ -0,0 +1,216 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "DungeonTileGrid.h"
+#include "CorridorRouter.h"
+#include "DungeonNavigationData.h"
+#include "DungeonLayout.generated.h"
+
+USTRUCT()
+struct FConnectingRoom
+{
+	GENERATED_BODY()
+
+	/** The indexes of the rooms in the Rooms array */
+	int32 RoomAIndex;
+	int32 RoomBIndex;
+};
+
+/** The generator settings the layout stage reads, copied so the layout can be generated away from the generator actor */
+struct FDungeonLayoutSettings
+{
+	/** The seed the layout's FRandomStream starts from */
+	int32 Seed = 0;
+
+	int32 NumberOfRooms = 15;
+	int32 MinRoomSize = 3;
+	int32 MaxRoomSize = 6;
+	int32 MinRoomDistance = 1;
+	int32 MaxRoomDistance = 3;
+	bool bRouteCorridors = false;
+	float LoopConnectionRatio = 0.f;
+	int32 MaxLoopCorridorLength = 6;
+	int32 ConfigVersion = 0;
+
+	/** Whether FinishLayout fills the MinimapPixels, cleared when nothing will draw the minimap such as on a dedicated server */
+	bool bRasterizeMinimap = true;
+
+	/** Set from any thread to stop generating between stages, the layout that comes back is then incomplete and has to be dropped */
+	TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> CancelFlag;
+
+	FORCEINLINE bool IsCancelled() const { return CancelFlag.IsValid() && *CancelFlag; }
+};
+
+/** A room of a generated layout packed into 8 bytes, in tiles. Rooms can't reach further than MAX_int16 tiles from the first room */
+struct FDungeonLayoutRoom
+{
+	/** The tile of the room's lowest corner */
+	int16 X = 0;
+	int16 Y = 0;
+
+	/** The number of tiles the room covers along the X and Y */
+	int16 SizeX = 0;
+	int16 SizeY = 0;
+
+	FORCEINLINE FIntPoint GetPosition() const { return FIntPoint(X, Y); }
+	FORCEINLINE FIntPoint GetSize() const { return FIntPoint(SizeX, SizeY); }
+	FORCEINLINE FIntPoint GetRoomMax() const { return FIntPoint(X + SizeX, Y + SizeY); }
+
+	/** Returns the tiles covered by the room, Max is exclusive */
+	FORCEINLINE FIntRect GetRoomRect() const { return FIntRect(GetPosition(), GetRoomMax()); }
+
+	/** Returns true if Position and Size can be packed into a room */
+	static bool CanPack(const FIntPoint& Position, const FIntPoint& Size);
+
+	/** Packs the Position and Size into a room, they must pass CanPack */
+	static FDungeonLayoutRoom Pack(const FIntPoint& Position, const FIntPoint& Size);
+};
+
+static_assert(sizeof(FDungeonLayoutRoom) == 8, "Layout rooms are expected to pack into 8 bytes");
+
+/** A door's wall pivot packed into 8 bytes, in the same tile coordinates as the rooms */
+struct FDungeonLayoutDoor
+{
+	int16 X = 0;
+	int16 Y = 0;
+
+	/** The index of the room the door opens into */
+	int32 RoomIndex = INDEX_NONE;
+
+	FORCEINLINE FIntPoint GetPivot() const { return FIntPoint(X, Y); }
+};
+
+static_assert(sizeof(FDungeonLayoutDoor) == 8, "Layout doors are expected to pack into 8 bytes");
+
+/** The rooms and corridors of a dungeon before anything is spawned. Never changed once generated so it can be shared between threads */
+struct FDungeonLayout
+{
+	/** The settings the layout was generated with */
+	FDungeonLayoutSettings Settings;
+
+	/** The rooms, a room's index is its position in the array */
+	TArray<FDungeonLayoutRoom> Rooms;
+
+	/** Each room connection contains the index of the two rooms */
+	TArray<FConnectingRoom> RoomConnections;
+
+	/**
+	 * The doors of every room. Once the layout is finished they are sorted by room then pivot with no repeats,
+	 * RoomDoorStarts has an entry per room plus one for the end
+	 */
+	TArray<FDungeonLayoutDoor> Doors;
+	TArray<int32> RoomDoorStarts;
+
+	/** The tile of the door between the lowest room and the starting area, the generator lines this up with its location */
+	FIntPoint StartPoint = FIntPoint::ZeroValue;
+
+	/** Every tile of the dungeon */
+	FDungeonTileGrid TileGrid;
+
+	/** The walkability grid and portal graph of the dungeon */
+	FDungeonNavigationData NavigationData;
+
+	/** The number of corridor networks labelled in the TileGrid */
+	int32 NumCorridors = 0;
+
+	/** The rooms reachable from each room through a corridor, RoomNeighbourStarts has an entry per room plus one for the end */
+	TArray<int32> RoomNeighbourStarts;
+	TArray<int32> RoomNeighbours;
+
+	/**
+	 * A texel per tile for the minimap, texel (X, Y) is the tile at TileGrid.Origin + (X, Y).
+	 * R is 255 for rooms, 128 for corridors and 0 for empty tiles. G is a bit per EDungeonDirection times 16, set on the sides with a wall.
+	 * A is 0 as everything starts hidden by the fog of war. Empty when the settings didn't ask for a minimap.
+	 */
+	TArray<FColor> MinimapPixels;
+
+	/** The current seed of the stream once the layout stage finished, everything after it uses the stream from here */
+	int32 PostLayoutSeed = 0;
+
+	/** The hash of the rooms, connections, tiles and stream state */
+	uint32 LayoutHash = 0;
+
+	/** Returns the doors of the room, only valid once the layout is finished */
+	FORCEINLINE TArrayView<const FDungeonLayoutDoor> GetRoomDoors(int32 RoomIndex) const
+	{
+		return MakeArrayView(Doors.GetData() + RoomDoorStarts[RoomIndex], RoomDoorStarts[RoomIndex + 1] - RoomDoorStarts[RoomIndex]);
+	}
+};
+
+/** Layouts are created on worker threads and read on the game thread */
+typedef TSharedRef<const FDungeonLayout, ESPMode::ThreadSafe> FDungeonLayoutRef;
+typedef TSharedPtr<const FDungeonLayout, ESPMode::ThreadSafe> FDungeonLayoutPtr;
+
+/**
+ * Places the rooms and routes the corridors of a dungeon.
+ * Only touches its own data so any number can run at once on different threads, the scratch buffers are kept between layouts.
+ */
+class DUNGEON_CPP_API FDungeonLayoutGenerator
+{
+public:
+
+	/** Generates a complete layout from the settings, unless they are cancelled part way through */
+	TSharedRef<FDungeonLayout, ESPMode::ThreadSafe> Generate(const FDungeonLayoutSettings& Settings);
+
+	/** Finds the lowest room on the X, records the point in the middle of its bottom wall as the StartPoint and adds a door there */
+	static void AddStartArea(FDungeonLayout& Layout);
+
+	/** Adds a door at the wall Pivot of the room, repeats are removed when the layout is finished */
+	static void AddDoor(FDungeonLayout& Layout, int32 RoomIndex, const FIntPoint& Pivot);
+
+	/** Builds the data that depends on the finished rooms and corridors and records the layout hash */
+	static void FinishLayout(FDungeonLayout& Layout, int32 PostLayoutSeed);
+
+	/** Hashes the rooms, connections, tiles and stream state */
+	static uint32 ComputeLayoutHash(const FDungeonLayout& Layout);
+
+	/** Fills the MinimapPixels from the TileGrid, a row at a time across the worker threads */
+	static void RasterizeMinimap(FDungeonLayout& Layout);
+
+private:
+
+	/** Places a newly generated room if it doesn't overlap with an existing room */
+	void TryPlaceRoom();
+
+	/** Checks if the Room overlaps or touches any of the placed rooms */
+	bool IsOverlappingOtherRooms(const FDungeonLayoutRoom& Room) const;
+
+	/** Sizes the TileGrid to fit every room and marks the tiles they cover */
+	void BuildTileGrid();
+
+	/** Adds extra connections between neighbouring rooms using the LoopConnectionRatio */
+	void AddLoopConnections();
+
+	/** Adds the corridor tiles between the rooms in each FConnectingRoom */
+	void CreateCorridors();
+
+	/** Adds a straight corridor from the CorridorStart to the CorridorEnd, returns false if it would pass through a room */
+	bool AddStraightCorridor(const FIntPoint& CorridorStart, const FIntPoint& CorridorEnd, int32 StartRoom, int32 EndRoom);
+
+	/** Marks the Path as corridor tiles and adds the doors where it meets the StartRoom and EndRoom */
+	void AddCorridorPath(const TArray<FIntPoint>& Path, int32 StartRoom, int32 EndRoom);
+
+	/** Adds a door to the room on the side of the corridor tile at Cell that touches the room */
+	void AddCorridorDoor(const FIntPoint& Cell, int32 RoomIndex);
+
+	/** Pick a random point where the two rooms will still overlap, pass in all X values or Y values */
+	int32 GetRandomPointWhereRoomsOverlap(int32 ConnectingRoomPosition, int32 ConnectingRoomExtent, int32 NewRoomSize);
+
+	/** Pick a random point alongside the connecting room, only overlapping it when corridors can't be routed. Pass in all X values or Y values */
+	int32 GetRandomPointAlongRoom(int32 ConnectingRoomPosition, int32 ConnectingRoomExtent, int32 NewRoomSize);
+
+	/** The layout being generated */
+	FDungeonLayout* Layout = nullptr;
+
+	/** The stream used to generate random numbers for the current layout */
+	FRandomStream Stream;
+
+	/** Routes corridors between rooms that aren't lined up */
+	FCorridorRouter CorridorRouter;
+
+	/** The tiles of the corridor currently being added, kept to avoid reallocating for every corridor */
+	TArray<FIntPoint> CorridorPath;
+};
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonLayoutSyncComponent.h"
+#include "DungeonGenerator.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDungeonLayoutSync, Log, All);
+
+UDungeonLayoutSyncComponent::UDungeonLayoutSyncComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	SetIsReplicatedByDefault(true);
+}
+
+void UDungeonLayoutSyncComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Dungeons generated before the PlayerController arrived couldn't report their layout yet
+	APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (PlayerController && PlayerController->IsLocalController() && !PlayerController->HasAuthority())
+	{
+		for (TActorIterator<ADungeonGenerator> It(GetWorld()); It; ++It)
+		{
+			if (It->HasGeneratedLayout())
+			{
+				ReportLayout(*It);
+			}
+		}
+	}
+}
+
+void UDungeonLayoutSyncComponent::ReportLayout(ADungeonGenerator* Generator)
+{
+	if (Generator)
+	{
+		ServerReportLayoutHash(Generator, static_cast<int32>(Generator->GetLayoutHash()), Generator->ConfigVersion);
+	}
+}
+
+void UDungeonLayoutSyncComponent::OnServerLayoutGenerated(ADungeonGenerator* Generator)
+{
+	FPendingLayoutReport PendingReport;
+
+	if (PendingLayoutReports.RemoveAndCopyValue(Generator, PendingReport))
+	{
+		CheckLayoutHash(Generator, PendingReport.LayoutHash, PendingReport.ConfigVersion);
+	}
+}
+
+bool UDungeonLayoutSyncComponent::ServerReportLayoutHash_Validate(ADungeonGenerator* Generator, int32 LayoutHash, int32 ConfigVersion)
+{
+	return Generator != nullptr;
+}
+
+void UDungeonLayoutSyncComponent::ServerReportLayoutHash_Implementation(ADungeonGenerator* Generator, int32 LayoutHash, int32 ConfigVersion)
+{
+	// A client can finish generating before the server does, so its hash is kept until the server's layout is ready
+	if (!Generator->HasGeneratedLayout())
+	{
+		PendingLayoutReports.Add(Generator, { LayoutHash, ConfigVersion });
+		return;
+	}
+
+	CheckLayoutHash(Generator, LayoutHash, ConfigVersion);
+}
+
+void UDungeonLayoutSyncComponent::CheckLayoutHash(ADungeonGenerator* Generator, int32 LayoutHash, int32 ConfigVersion)
+{
+	if (!IsGeneratorRelevant(Generator))
+	{
+		return;
+	}
+
+	if (static_cast<uint32>(LayoutHash) == Generator->GetLayoutHash() && ConfigVersion == Generator->ConfigVersion)
+	{
+		return;
+	}
+
+	// Building a snapshot compresses the whole layout, so a client that keeps reporting the wrong hash is only sent the first one
+	uint32* SentHash = SentSnapshotHashes.Find(Generator);
+
+	if (SentHash && *SentHash == Generator->GetLayoutHash())
+	{
+		return;
+	}
+
+	SentSnapshotHashes.Add(Generator, Generator->GetLayoutHash());
+
+	UE_LOG(LogDungeonLayoutSync, Warning, TEXT("%s has a different layout on %s, sending a snapshot"), *Generator->GetName(), *GetOwner()->GetName());
+
+	TArray<uint8> Snapshot;
+	Generator->BuildLayoutSnapshot(Snapshot);
+
+	// Split the snapshot up so no single RPC gets too big
+	for (int32 Offset = 0; Offset < Snapshot.Num(); Offset += SnapshotChunkSize)
+	{
+		TArray<uint8> Chunk(Snapshot.GetData() + Offset, FMath::Min(SnapshotChunkSize, Snapshot.Num() - Offset));
+		ClientReceiveLayoutSnapshot(Generator, Snapshot.Num(), Offset, Chunk);
+	}
+}
+
+bool UDungeonLayoutSyncComponent::IsGeneratorRelevant(const ADungeonGenerator* Generator) const
+{
+	APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+
+	if (!PlayerController || Generator->GetWorld() != GetWorld())
+	{
+		return false;
+	}
+
+	AActor* ViewTarget = PlayerController->GetViewTarget();
+	return Generator->IsNetRelevantFor(PlayerController, ViewTarget ? ViewTarget : PlayerController, PlayerController->GetFocalLocation());
+}
+
+void UDungeonLayoutSyncComponent::ClientReceiveLayoutSnapshot_Implementation(ADungeonGenerator* Generator, int32 TotalSize, int32 Offset, const TArray<uint8>& Chunk)
+{
+	if (TotalSize <= 0 || TotalSize > MaxSnapshotSize)
+	{
+		RejectLayoutSnapshot(TEXT("it is too big"));
+		return;
+	}
+
+	// A new snapshot always starts at zero and drops whatever was left of an earlier one
+	if (Offset == 0)
+	{
+		ReceivedSnapshot.Reset(TotalSize);
+	}
+
+	if (Offset != ReceivedSnapshot.Num() || Chunk.Num() > TotalSize - Offset)
+	{
+		RejectLayoutSnapshot(TEXT("a chunk arrived out of order"));
+		return;
+	}
+
+	ReceivedSnapshot.Append(Chunk);
+
+	if (ReceivedSnapshot.Num() == TotalSize && Generator)
+	{
+		if (!Generator->ApplyLayoutSnapshot(ReceivedSnapshot))
+		{
+			UE_LOG(LogDungeonLayoutSync, Error, TEXT("Unable to apply the layout snapshot for %s"), *Generator->GetName());
+		}
+
+		ReceivedSnapshot.Empty();
+	}
+}
+
+void UDungeonLayoutSyncComponent::RejectLayoutSnapshot(const TCHAR* Reason)
+{
+	UE_LOG(LogDungeonLayoutSync, Warning, TEXT("Dropping a layout snapshot because %s"), Reason);
+
+	ReceivedSnapshot.Empty();
+}
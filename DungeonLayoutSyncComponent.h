@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "DungeonLayoutSyncComponent.generated.h"
+
+/**
+ * Add to the PlayerController so clients can check their locally generated dungeons against the server.
+ * Clients only send a hash of their layout, the full layout is only sent back down if the hashes don't match.
+ */
+UCLASS(ClassGroup = (Dungeon), meta = (BlueprintSpawnableComponent))
+class DUNGEON_CPP_API UDungeonLayoutSyncComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UDungeonLayoutSyncComponent();
+
+	/** The largest piece of a layout snapshot sent in one RPC */
+	static constexpr int32 SnapshotChunkSize = 16 * 1024;
+
+	/** The largest compressed layout snapshot a client will receive */
+	static constexpr int32 MaxSnapshotSize = 4 * 1024 * 1024;
+
+	/** Sends the hash of the Generator's layout to the server to be checked */
+	void ReportLayout(class ADungeonGenerator* Generator);
+
+	/** Checks any hash this connection reported for the Generator before the server had a layout to compare it with, only used on the server */
+	void OnServerLayoutGenerated(class ADungeonGenerator* Generator);
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+private:
+
+	/** Compares the client's layout hash with the server's and sends a snapshot if they differ */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerReportLayoutHash(class ADungeonGenerator* Generator, int32 LayoutHash, int32 ConfigVersion);
+
+	/** Receives part of a compressed layout snapshot, the layout is applied once all of it has arrived */
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveLayoutSnapshot(class ADungeonGenerator* Generator, int32 TotalSize, int32 Offset, const TArray<uint8>& Chunk);
+
+	/** Sends a snapshot of the Generator's layout if the client's hash doesn't match it, the Generator must have a layout */
+	void CheckLayoutHash(class ADungeonGenerator* Generator, int32 LayoutHash, int32 ConfigVersion);
+
+	/** Returns true if the owning connection can see the Generator, only used on the server */
+	bool IsGeneratorRelevant(const class ADungeonGenerator* Generator) const;
+
+	/** Drops a snapshot that arrived out of order or bigger than it said it would be */
+	void RejectLayoutSnapshot(const TCHAR* Reason);
+
+	/** The snapshot being received */
+	TArray<uint8> ReceivedSnapshot;
+
+	/** A hash reported by the client, kept until the server has a layout to compare it with */
+	struct FPendingLayoutReport
+	{
+		int32 LayoutHash;
+		int32 ConfigVersion;
+	};
+
+	/** The latest hash the client reported for each generator that was still generating on the server, only used on the server */
+	TMap<TWeakObjectPtr<class ADungeonGenerator>, FPendingLayoutReport> PendingLayoutReports;
+
+	/**
+	 * The hash of the layout each generator last sent this connection a snapshot of, only used on the server.
+	 * A connection is sent at most one snapshot per layout however many mismatching hashes it reports
+	 */
+	TMap<TWeakObjectPtr<class ADungeonGenerator>, uint32> SentSnapshotHashes;
+};
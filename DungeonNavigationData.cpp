@@ -0,0 +1,471 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonNavigationData.h"
+#include "DungeonLayout.h"
+#include "Algo/Reverse.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDungeonNavigation, Log, All);
+
+/** A run of corridor tiles from one node of a corridor network to another */
+struct FNavNetworkEdge
+{
+	int32 ToNode;
+
+	/** The number of tiles walked to reach the ToNode */
+	int32 Length;
+};
+
+struct FNavOpenNode
+{
+	int32 Node;
+	int32 Cost;
+};
+
+static int32 CountCorridorNeighbours(const FDungeonTileGrid& Grid, const FIntPoint& Cell)
+{
+	int32 NumNeighbours = 0;
+
+	for (uint8 Side = 0; Side < 4; Side++)
+	{
+		NumNeighbours += Grid.GetTileType(FDungeonTileGrid::GetNeighbour(Cell, static_cast<EDungeonDirection>(Side))) == EDungeonTileType::Corridor;
+	}
+
+	return NumNeighbours;
+}
+
+/** Returns the corridor tile after Cell that isn't Previous, Cell must have exactly two corridor neighbours */
+static FIntPoint FindNextInRun(const FDungeonTileGrid& Grid, const FIntPoint& Cell, const FIntPoint& Previous)
+{
+	for (uint8 Side = 0; Side < 4; Side++)
+	{
+		FIntPoint Neighbour = FDungeonTileGrid::GetNeighbour(Cell, static_cast<EDungeonDirection>(Side));
+
+		if (Neighbour != Previous && Grid.GetTileType(Neighbour) == EDungeonTileType::Corridor)
+		{
+			return Neighbour;
+		}
+	}
+
+	return Previous;
+}
+
+/** Returns the number of corridor tiles walked from one tile to another, counting both ends, by walking the grid a tile at a time */
+static int32 WalkCorridorDistance(const FDungeonTileGrid& Grid, const FIntPoint& From, const FIntPoint& To)
+{
+	TArray<int32> Distances;
+	TArray<int32> Queue;
+	Distances.Init(INDEX_NONE, Grid.Num());
+	Queue.Add(Grid.ToIndex(From));
+	Distances[Queue[0]] = 1;
+
+	for (int32 Head = 0; Head < Queue.Num(); Head++)
+	{
+		FIntPoint Cell = Grid.ToCell(Queue[Head]);
+
+		if (Cell == To)
+		{
+			return Distances[Queue[Head]];
+		}
+
+		for (uint8 Side = 0; Side < 4; Side++)
+		{
+			FIntPoint Neighbour = FDungeonTileGrid::GetNeighbour(Cell, static_cast<EDungeonDirection>(Side));
+
+			if (Grid.GetTileType(Neighbour) == EDungeonTileType::Corridor && Distances[Grid.ToIndex(Neighbour)] == INDEX_NONE)
+			{
+				Distances[Grid.ToIndex(Neighbour)] = Distances[Queue[Head]] + 1;
+				Queue.Add(Grid.ToIndex(Neighbour));
+			}
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+/** Builds the navigation data of a large dungeon whose corridors merge into big networks, then checks every link against a tile by tile walk */
+static FAutoConsoleCommand VerifyNavigationCommand(
+	TEXT("Dungeon.VerifyNavigation"),
+	TEXT("Generates a large dungeon with routed and looping corridors, times building its navigation data and checks every link's cost. Usage: Dungeon.VerifyNavigation [NumRooms]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FDungeonLayoutSettings Settings;
+		Settings.Seed = 1;
+		Settings.NumberOfRooms = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 2) : 400;
+		Settings.bRouteCorridors = true;
+		Settings.LoopConnectionRatio = 1.f;
+		Settings.bRasterizeMinimap = false;
+
+		FDungeonLayoutGenerator Generator;
+		TSharedRef<FDungeonLayout, ESPMode::ThreadSafe> Layout = Generator.Generate(Settings);
+
+		FDungeonNavigationData NavigationData;
+		double StartTime = FPlatformTime::Seconds();
+		NavigationData.Build(Layout->TileGrid, Layout->Rooms.Num());
+		double BuildTime = FPlatformTime::Seconds() - StartTime;
+
+		int32 NumWrongLinks = 0;
+
+		for (const FDungeonNavLink& Link : NavigationData.Links)
+		{
+			int32 Expected = WalkCorridorDistance(Layout->TileGrid, NavigationData.Doors[Link.FromDoor].CorridorTile, NavigationData.Doors[Link.ToDoor].CorridorTile);
+
+			if (Link.Cost != Expected)
+			{
+				NumWrongLinks++;
+			}
+		}
+
+		UE_LOG(LogDungeonNavigation, Log, TEXT("Built navigation for %d rooms, %d corridor networks, %d doors and %d links in %.3fms"),
+			Layout->Rooms.Num(), Layout->NumCorridors, NavigationData.Doors.Num(), NavigationData.Links.Num(), BuildTime * 1000.0);
+
+		if (NumWrongLinks > 0)
+		{
+			UE_LOG(LogDungeonNavigation, Error, TEXT("%d of %d links don't match the distance walked along the corridors"), NumWrongLinks, NavigationData.Links.Num());
+		}
+	}));
+
+void FDungeonNavigationData::Build(const FDungeonTileGrid& Grid, int32 NumRooms)
+{
+	Origin = Grid.Origin;
+	Width = Grid.Width;
+	Height = Grid.Height;
+
+	Walkable.Init(false, Grid.Num());
+	Doors.Reset();
+	Links.Reset();
+
+	for (int32 Index = 0; Index < Grid.Num(); Index++)
+	{
+		Walkable[Index] = Grid.Tiles[Index].Type != EDungeonTileType::Empty;
+	}
+
+	FMemMark Mark(FMemStack::Get());
+
+	// Corridors can merge so doors are linked through the whole network of corridor tiles they open on to
+	TDungeonScratchArray<bool> Visited;
+	Visited.Init(false, Grid.Num());
+
+	// The network is walked as a graph of its junctions and door tiles, the straight runs of tiles between them become single edges.
+	// A large merged network has far fewer of these than tiles so each door's search only visits the nodes
+	TDungeonScratchArray<int32> NodeOfTile;
+	NodeOfTile.Init(INDEX_NONE, Grid.Num());
+
+	TDungeonScratchArray<int32> NetworkTiles;
+	TDungeonScratchArray<int32> NetworkDoors;
+	TDungeonScratchArray<int32> NodeTiles;
+	TDungeonScratchArray<int32> NodeEdgeStarts;
+	TDungeonScratchArray<FNavNetworkEdge> NodeEdges;
+	TDungeonScratchArray<int32> NodeCosts;
+	TDungeonScratchArray<FNavOpenNode> OpenList;
+
+	for (int32 Index = 0; Index < Grid.Num(); Index++)
+	{
+		if (Grid.Tiles[Index].Type != EDungeonTileType::Corridor || Visited[Index])
+		{
+			continue;
+		}
+
+		NetworkTiles.Reset();
+		NetworkDoors.Reset();
+
+		Visited[Index] = true;
+		NetworkTiles.Add(Index);
+
+		// Flood fill the corridor network and collect the doors along it
+		for (int32 Head = 0; Head < NetworkTiles.Num(); Head++)
+		{
+			FIntPoint Cell = Grid.ToCell(NetworkTiles[Head]);
+			const FDungeonTile& Tile = Grid.Tiles[NetworkTiles[Head]];
+
+			for (uint8 Side = 0; Side < 4; Side++)
+			{
+				FIntPoint Neighbour = FDungeonTileGrid::GetNeighbour(Cell, static_cast<EDungeonDirection>(Side));
+
+				if (Tile.DoorMask & (1 << Side))
+				{
+					FDungeonNavDoor Door;
+					Door.CorridorTile = Cell;
+					Door.RoomTile = Neighbour;
+					Door.RoomIndex = Grid.GetTile(Neighbour).RoomIndex;
+
+					NetworkDoors.Add(Doors.Add(Door));
+				}
+				else if (Grid.GetTileType(Neighbour) == EDungeonTileType::Corridor && !Visited[Grid.ToIndex(Neighbour)])
+				{
+					Visited[Grid.ToIndex(Neighbour)] = true;
+					NetworkTiles.Add(Grid.ToIndex(Neighbour));
+				}
+			}
+		}
+
+		if (NetworkDoors.Num() < 2)
+		{
+			continue;
+		}
+
+		// Door tiles and any tile that isn't part of a straight or bending run are the nodes
+		NodeTiles.Reset();
+
+		for (int32 TileIndex : NetworkTiles)
+		{
+			if (Grid.Tiles[TileIndex].DoorMask != 0 || CountCorridorNeighbours(Grid, Grid.ToCell(TileIndex)) != 2)
+			{
+				NodeOfTile[TileIndex] = NodeTiles.Add(TileIndex);
+			}
+		}
+
+		// Follow each run out of every node until it reaches the next node
+		NodeEdgeStarts.Reset();
+		NodeEdges.Reset();
+
+		for (int32 TileIndex : NodeTiles)
+		{
+			NodeEdgeStarts.Add(NodeEdges.Num());
+			FIntPoint NodeCell = Grid.ToCell(TileIndex);
+
+			for (uint8 Side = 0; Side < 4; Side++)
+			{
+				FIntPoint Previous = NodeCell;
+				FIntPoint Current = FDungeonTileGrid::GetNeighbour(NodeCell, static_cast<EDungeonDirection>(Side));
+				int32 Length = 1;
+
+				if (Grid.GetTileType(Current) != EDungeonTileType::Corridor)
+				{
+					continue;
+				}
+
+				while (NodeOfTile[Grid.ToIndex(Current)] == INDEX_NONE)
+				{
+					FIntPoint Next = FindNextInRun(Grid, Current, Previous);
+					Previous = Current;
+					Current = Next;
+					Length++;
+				}
+
+				if (Current != NodeCell)
+				{
+					NodeEdges.Add({ NodeOfTile[Grid.ToIndex(Current)], Length });
+				}
+			}
+		}
+
+		NodeEdgeStarts.Add(NodeEdges.Num());
+
+		// Search the node graph once from each door tile, doors on the same tile share the search
+		NodeCosts.SetNumUninitialized(NodeTiles.Num());
+
+		for (int32 FromIndex = 0; FromIndex < NetworkDoors.Num(); FromIndex++)
+		{
+			int32 FromNode = NodeOfTile[Grid.ToIndex(Doors[NetworkDoors[FromIndex]].CorridorTile)];
+			bool bAlreadySearched = false;
+
+			for (int32 i = 0; i < FromIndex && !bAlreadySearched; i++)
+			{
+				bAlreadySearched = NodeOfTile[Grid.ToIndex(Doors[NetworkDoors[i]].CorridorTile)] == FromNode;
+			}
+
+			if (bAlreadySearched)
+			{
+				continue;
+			}
+
+			for (int32& Cost : NodeCosts)
+			{
+				Cost = MAX_int32;
+			}
+
+			auto OpenNodePredicate = [](const FNavOpenNode& A, const FNavOpenNode& B) { return A.Cost < B.Cost; };
+
+			// Costs count the tiles walked including both door tiles, the same as walking the corridor tile by tile
+			NodeCosts[FromNode] = 1;
+			OpenList.Reset();
+			OpenList.HeapPush({ FromNode, 1 }, OpenNodePredicate);
+
+			while (OpenList.Num() > 0)
+			{
+				FNavOpenNode Current;
+				OpenList.HeapPop(Current, OpenNodePredicate, false);
+
+				if (Current.Cost != NodeCosts[Current.Node])
+				{
+					continue;
+				}
+
+				for (int32 EdgeIndex = NodeEdgeStarts[Current.Node]; EdgeIndex < NodeEdgeStarts[Current.Node + 1]; EdgeIndex++)
+				{
+					const FNavNetworkEdge& Edge = NodeEdges[EdgeIndex];
+					int32 Cost = Current.Cost + Edge.Length;
+
+					if (Cost < NodeCosts[Edge.ToNode])
+					{
+						NodeCosts[Edge.ToNode] = Cost;
+						OpenList.HeapPush({ Edge.ToNode, Cost }, OpenNodePredicate);
+					}
+				}
+			}
+
+			for (int32 FromDoor : NetworkDoors)
+			{
+				if (NodeOfTile[Grid.ToIndex(Doors[FromDoor].CorridorTile)] != FromNode)
+				{
+					continue;
+				}
+
+				for (int32 ToDoor : NetworkDoors)
+				{
+					if (Doors[ToDoor].RoomIndex != Doors[FromDoor].RoomIndex)
+					{
+						FDungeonNavLink Link;
+						Link.FromDoor = FromDoor;
+						Link.ToDoor = ToDoor;
+						Link.Cost = NodeCosts[NodeOfTile[Grid.ToIndex(Doors[ToDoor].CorridorTile)]];
+
+						Links.Add(Link);
+					}
+				}
+			}
+		}
+
+		for (int32 TileIndex : NodeTiles)
+		{
+			NodeOfTile[TileIndex] = INDEX_NONE;
+		}
+	}
+
+	// Group the links by the room they leave from so each room's links can be looked up directly
+	Links.Sort([this](const FDungeonNavLink& A, const FDungeonNavLink& B)
+	{
+		if (Doors[A.FromDoor].RoomIndex != Doors[B.FromDoor].RoomIndex)
+			return Doors[A.FromDoor].RoomIndex < Doors[B.FromDoor].RoomIndex;
+
+		return A.FromDoor != B.FromDoor ? A.FromDoor < B.FromDoor : A.ToDoor < B.ToDoor;
+	});
+
+	RoomLinkStarts.Init(0, NumRooms + 1);
+
+	for (const FDungeonNavLink& Link : Links)
+	{
+		RoomLinkStarts[Doors[Link.FromDoor].RoomIndex + 1]++;
+	}
+
+	for (int32 RoomIndex = 1; RoomIndex <= NumRooms; RoomIndex++)
+	{
+		RoomLinkStarts[RoomIndex] += RoomLinkStarts[RoomIndex - 1];
+	}
+}
+
+bool FDungeonNavigationData::IsWalkable(const FIntPoint& Tile) const
+{
+	FIntPoint Local = Tile - Origin;
+
+	if (Local.X < 0 || Local.Y < 0 || Local.X >= Width || Local.Y >= Height)
+	{
+		return false;
+	}
+
+	return Walkable[Local.X * Height + Local.Y];
+}
+
+TArrayView<const FDungeonNavLink> FDungeonNavigationData::GetRoomLinks(int32 RoomIndex) const
+{
+	if (!RoomLinkStarts.IsValidIndex(RoomIndex + 1) || RoomIndex < 0)
+	{
+		return TArrayView<const FDungeonNavLink>();
+	}
+
+	return MakeArrayView(Links.GetData() + RoomLinkStarts[RoomIndex], RoomLinkStarts[RoomIndex + 1] - RoomLinkStarts[RoomIndex]);
+}
+
+bool FDungeonNavigationData::FindRoomPath(int32 StartRoom, int32 GoalRoom, TArray<int32>& OutLinks) const
+{
+	OutLinks.Reset();
+
+	if (StartRoom < 0 || GoalRoom < 0 || !RoomLinkStarts.IsValidIndex(StartRoom + 1) || !RoomLinkStarts.IsValidIndex(GoalRoom + 1))
+	{
+		return false;
+	}
+
+	if (StartRoom == GoalRoom)
+	{
+		return true;
+	}
+
+	struct FOpenDoor
+	{
+		int32 Door;
+		int32 Cost;
+	};
+
+	auto OpenDoorPredicate = [](const FOpenDoor& A, const FOpenDoor& B) { return A.Cost < B.Cost; };
+
+	// Each search state is the door a room was entered through
+	TArray<int32> Costs;
+	TArray<int32> ArrivedBy;
+	TArray<int32> PreviousDoor;
+	TArray<FOpenDoor> OpenList;
+	Costs.Init(MAX_int32, Doors.Num());
+	ArrivedBy.Init(INDEX_NONE, Doors.Num());
+	PreviousDoor.Init(INDEX_NONE, Doors.Num());
+
+	auto LeaveRoom = [&](int32 RoomIndex, int32 EnteredThrough, int32 CostSoFar)
+	{
+		for (int32 LinkIndex = RoomLinkStarts[RoomIndex]; LinkIndex < RoomLinkStarts[RoomIndex + 1]; LinkIndex++)
+		{
+			const FDungeonNavLink& Link = Links[LinkIndex];
+
+			// Walking across the room from the door we came in through to the door we leave by
+			int32 WalkCost = 0;
+			if (EnteredThrough != INDEX_NONE)
+			{
+				FIntPoint Difference = Doors[Link.FromDoor].RoomTile - Doors[EnteredThrough].RoomTile;
+				WalkCost = FMath::Abs(Difference.X) + FMath::Abs(Difference.Y);
+			}
+
+			int32 Cost = CostSoFar + WalkCost + Link.Cost;
+
+			if (Cost < Costs[Link.ToDoor])
+			{
+				Costs[Link.ToDoor] = Cost;
+				ArrivedBy[Link.ToDoor] = LinkIndex;
+				PreviousDoor[Link.ToDoor] = EnteredThrough;
+				OpenList.HeapPush({ Link.ToDoor, Cost }, OpenDoorPredicate);
+			}
+		}
+	};
+
+	LeaveRoom(StartRoom, INDEX_NONE, 0);
+
+	while (OpenList.Num() > 0)
+	{
+		FOpenDoor Current;
+		OpenList.HeapPop(Current, OpenDoorPredicate, false);
+
+		if (Current.Cost != Costs[Current.Door])
+		{
+			continue;
+		}
+
+		int32 RoomIndex = Doors[Current.Door].RoomIndex;
+
+		if (RoomIndex == GoalRoom)
+		{
+			for (int32 Door = Current.Door; Door != INDEX_NONE; Door = PreviousDoor[Door])
+			{
+				OutLinks.Add(ArrivedBy[Door]);
+			}
+
+			Algo::Reverse(OutLinks);
+			return true;
+		}
+
+		if (RoomIndex != StartRoom)
+		{
+			LeaveRoom(RoomIndex, Current.Door, Current.Cost);
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonTileGrid.h"
+#include "DungeonNavigationData.generated.h"
+
+/** A corridor leading out of a room through a door, in world space */
+USTRUCT(BlueprintType)
+struct FDungeonPortal
+{
+	GENERATED_BODY()
+
+	/** The room the portal leaves from */
+	UPROPERTY(BlueprintReadOnly)
+	int32 RoomIndex = INDEX_NONE;
+
+	/** The room at the other end of the corridor */
+	UPROPERTY(BlueprintReadOnly)
+	int32 ConnectedRoomIndex = INDEX_NONE;
+
+	/** The centre of the doorway leaving the room */
+	UPROPERTY(BlueprintReadOnly)
+	FVector Location = FVector::ZeroVector;
+
+	/** The centre of the doorway entering the connected room */
+	UPROPERTY(BlueprintReadOnly)
+	FVector ConnectedLocation = FVector::ZeroVector;
+
+	/** The number of corridor tiles walked between the two doorways */
+	UPROPERTY(BlueprintReadOnly)
+	int32 CorridorLength = 0;
+};
+
+/** A doorway between a corridor tile and a room tile */
+struct FDungeonNavDoor
+{
+	FIntPoint CorridorTile;
+	FIntPoint RoomTile;
+	int32 RoomIndex;
+};
+
+/** A walk along the corridors from one door to another */
+struct FDungeonNavLink
+{
+	int32 FromDoor;
+	int32 ToDoor;
+
+	/** The number of corridor tiles walked */
+	int32 Cost;
+};
+
+/**
+ * Navigation data built straight from the tile layout so AI can plan routes without a navmesh.
+ * Holds a one bit per tile walkability grid and a graph of rooms connected by portals through the corridors.
+ */
+class DUNGEON_CPP_API FDungeonNavigationData
+{
+public:
+
+	/** Builds the walkability grid and portal graph from a finished tile grid */
+	void Build(const FDungeonTileGrid& Grid, int32 NumRooms);
+
+	/** Returns true if the tile is part of a room or corridor */
+	bool IsWalkable(const FIntPoint& Tile) const;
+
+	/** Returns the links leaving the doors of a room */
+	TArrayView<const FDungeonNavLink> GetRoomLinks(int32 RoomIndex) const;
+
+	/**
+	 * Finds the shortest route between two rooms through the portal graph.
+	 * Walking across a room between two of its doors costs the tile distance between them.
+	 * Fills OutLinks with the indexes into Links in the order they're walked.
+	 */
+	bool FindRoomPath(int32 StartRoom, int32 GoalRoom, TArray<int32>& OutLinks) const;
+
+	/** The tile coordinate of the first bit in the Walkable grid */
+	FIntPoint Origin = FIntPoint::ZeroValue;
+
+	/** The number of tiles along the X and Y of the Walkable grid */
+	int32 Width = 0;
+	int32 Height = 0;
+
+	/** A bit per tile stored X major, set if the tile can be walked on */
+	TBitArray<> Walkable;
+
+	/** Every door between a corridor and a room */
+	TArray<FDungeonNavDoor> Doors;
+
+	/** Every corridor walk between doors of different rooms, sorted by the room of the FromDoor */
+	TArray<FDungeonNavLink> Links;
+
+	/** Where each room's links start in Links, has an extra entry at the end so a room's links end where the next room's start */
+	TArray<int32> RoomLinkStarts;
+};
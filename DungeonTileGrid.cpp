@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DungeonTileGrid.h"
+
+void FDungeonTileGrid::Initialize(const FIntPoint& Min, const FIntPoint& Max)
+{
+	Origin = Min;
+	Width = FMath::Max(Max.X - Min.X, 0);
+	Height = FMath::Max(Max.Y - Min.Y, 0);
+
+	// Reset keeps the allocation around so regenerating doesn't hit the heap again
+	Tiles.Reset();
+	Tiles.SetNum(Width * Height);
+}
+
+void FDungeonTileGrid::MarkRoom(const FIntPoint& Position, const FIntPoint& Size, int32 RoomIndex)
+{
+	for (int32 x = Position.X; x < Position.X + Size.X; x++)
+	{
+		for (int32 y = Position.Y; y < Position.Y + Size.Y; y++)
+		{
+			FDungeonTile& Tile = GetTile(FIntPoint(x, y));
+			Tile.Type = EDungeonTileType::Room;
+			Tile.RoomIndex = RoomIndex;
+		}
+	}
+}
+
+void FDungeonTileGrid::FindNeighbouringRooms(int32 MaxDistance, TDungeonScratchArray<FRoomAdjacency>& OutNeighbours) const
+{
+	OutNeighbours.Reset();
+
+	// The room each tile was reached from and the number of tiles from that room
+	TDungeonScratchArray<int32> Owners;
+	TDungeonScratchArray<int32> Distances;
+	Owners.Init(INDEX_NONE, Tiles.Num());
+	Distances.Init(0, Tiles.Num());
+
+	TDungeonScratchArray<int32> Queue;
+	Queue.Reserve(Tiles.Num());
+
+	// Every room tile is a starting point
+	for (int32 Index = 0; Index < Tiles.Num(); Index++)
+	{
+		if (Tiles[Index].Type == EDungeonTileType::Room)
+		{
+			Owners[Index] = Tiles[Index].RoomIndex;
+			Queue.Add(Index);
+		}
+	}
+
+	for (int32 Head = 0; Head < Queue.Num(); Head++)
+	{
+		int32 Index = Queue[Head];
+		FIntPoint Cell = ToCell(Index);
+
+		for (uint8 Side = 0; Side < 4; Side++)
+		{
+			FIntPoint NeighbourCell = GetNeighbour(Cell, static_cast<EDungeonDirection>(Side));
+
+			if (!IsInside(NeighbourCell))
+			{
+				continue;
+			}
+
+			int32 NeighbourIndex = ToIndex(NeighbourCell);
+
+			if (Owners[NeighbourIndex] == INDEX_NONE)
+			{
+				// Stop growing once the room can't meet another within MaxDistance
+				if (Distances[Index] < MaxDistance)
+				{
+					Owners[NeighbourIndex] = Owners[Index];
+					Distances[NeighbourIndex] = Distances[Index] + 1;
+					Queue.Add(NeighbourIndex);
+				}
+			}
+			else if (Owners[NeighbourIndex] != Owners[Index])
+			{
+				// Two rooms have grown into each other
+				int32 Distance = Distances[Index] + Distances[NeighbourIndex];
+
+				if (Distance > MaxDistance)
+				{
+					continue;
+				}
+
+				FRoomAdjacency Pair;
+				Pair.RoomAIndex = FMath::Min(Owners[Index], Owners[NeighbourIndex]);
+				Pair.RoomBIndex = FMath::Max(Owners[Index], Owners[NeighbourIndex]);
+				Pair.Distance = Distance;
+
+				OutNeighbours.Add(Pair);
+			}
+		}
+	}
+
+	// Rooms meet all along the boundary between them, sort the meetings so only the closest one of each pair is kept
+	OutNeighbours.Sort([](const FRoomAdjacency& A, const FRoomAdjacency& B)
+	{
+		uint64 KeyA = FRoomAdjacency::MakeKey(A.RoomAIndex, A.RoomBIndex);
+		uint64 KeyB = FRoomAdjacency::MakeKey(B.RoomAIndex, B.RoomBIndex);
+
+		return KeyA != KeyB ? KeyA < KeyB : A.Distance < B.Distance;
+	});
+
+	int32 NumPairs = 0;
+
+	for (int32 i = 0; i < OutNeighbours.Num(); i++)
+	{
+		if (NumPairs == 0 || OutNeighbours[i].RoomAIndex != OutNeighbours[NumPairs - 1].RoomAIndex || OutNeighbours[i].RoomBIndex != OutNeighbours[NumPairs - 1].RoomBIndex)
+		{
+			OutNeighbours[NumPairs++] = OutNeighbours[i];
+		}
+	}
+
+	OutNeighbours.SetNum(NumPairs, false);
+}
+
+int32 FDungeonTileGrid::LabelCorridors()
+{
+	for (FDungeonTile& Tile : Tiles)
+	{
+		Tile.CorridorIndex = INDEX_NONE;
+	}
+
+	FMemMark Mark(FMemStack::Get());
+
+	int32 NumCorridors = 0;
+	TDungeonScratchArray<int32> Queue;
+
+	for (int32 Index = 0; Index < Tiles.Num(); Index++)
+	{
+		if (Tiles[Index].Type != EDungeonTileType::Corridor || Tiles[Index].CorridorIndex != INDEX_NONE)
+		{
+			continue;
+		}
+
+		Queue.Reset();
+		Queue.Add(Index);
+		Tiles[Index].CorridorIndex = NumCorridors;
+
+		for (int32 Head = 0; Head < Queue.Num(); Head++)
+		{
+			FIntPoint Cell = ToCell(Queue[Head]);
+
+			for (uint8 Side = 0; Side < 4; Side++)
+			{
+				FIntPoint Neighbour = GetNeighbour(Cell, static_cast<EDungeonDirection>(Side));
+
+				if (GetTileType(Neighbour) == EDungeonTileType::Corridor && GetTile(Neighbour).CorridorIndex == INDEX_NONE)
+				{
+					GetTile(Neighbour).CorridorIndex = NumCorridors;
+					Queue.Add(ToIndex(Neighbour));
+				}
+			}
+		}
+
+		NumCorridors++;
+	}
+
+	return NumCorridors;
+}
+
+void FDungeonTileGrid::PackTiles(int32 StartIndex, int32 Count, uint8* OutPackedTiles) const
+{
+	check(StartIndex >= 0 && StartIndex + Count <= Tiles.Num());
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FDungeonTile& Tile = Tiles[StartIndex + i];
+		OutPackedTiles[i] = static_cast<uint8>(Tile.Type) | (Tile.DoorMask << 2);
+	}
+}
+
+bool FDungeonTileGrid::UnpackTiles(const TArray<uint8>& PackedTiles)
+{
+	if (PackedTiles.Num() != Tiles.Num())
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Tiles.Num(); Index++)
+	{
+		if ((PackedTiles[Index] & 0x3) > static_cast<uint8>(EDungeonTileType::Corridor))
+		{
+			return false;
+		}
+
+		Tiles[Index].Type = static_cast<EDungeonTileType>(PackedTiles[Index] & 0x3);
+		Tiles[Index].DoorMask = PackedTiles[Index] >> 2;
+		Tiles[Index].RoomIndex = INDEX_NONE;
+		Tiles[Index].CorridorIndex = INDEX_NONE;
+	}
+
+	return true;
+}
+
+FIntPoint FDungeonTileGrid::GetNeighbour(const FIntPoint& Cell, EDungeonDirection Side)
+{
+	switch (Side)
+	{
+	case EDungeonDirection::Top:
+		return FIntPoint(Cell.X + 1, Cell.Y);
+	case EDungeonDirection::Right:
+		return FIntPoint(Cell.X, Cell.Y + 1);
+	case EDungeonDirection::Bottom:
+		return FIntPoint(Cell.X - 1, Cell.Y);
+	case EDungeonDirection::Left:
+	default:
+		return FIntPoint(Cell.X, Cell.Y - 1);
+	}
+}
+
+EDungeonDirection FDungeonTileGrid::GetOpposite(EDungeonDirection Side)
+{
+	return static_cast<EDungeonDirection>((static_cast<uint8>(Side) + 2) % 4);
+}
+
+FIntPoint FDungeonTileGrid::GetWallPivot(const FIntPoint& Cell, EDungeonDirection Side)
+{
+	// Wall meshes run along their local Y from the pivot and face their local X
+	switch (Side)
+	{
+	case EDungeonDirection::Top:
+		return FIntPoint(Cell.X + 1, Cell.Y + 1);
+	case EDungeonDirection::Right:
+		return FIntPoint(Cell.X, Cell.Y + 1);
+	case EDungeonDirection::Bottom:
+		return Cell;
+	case EDungeonDirection::Left:
+	default:
+		return FIntPoint(Cell.X + 1, Cell.Y);
+	}
+}
+
+FRotator FDungeonTileGrid::GetWallRotation(EDungeonDirection Side)
+{
+	switch (Side)
+	{
+	case EDungeonDirection::Top:
+		return FRotator(0.f, 180.f, 0.f);
+	case EDungeonDirection::Right:
+		return FRotator(0.f, -90.f, 0.f);
+	case EDungeonDirection::Bottom:
+		return FRotator(0.f);
+	case EDungeonDirection::Left:
+	default:
+		return FRotator(0.f, 90.f, 0.f);
+	}
+}
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+
+/**
+ * An array that only lives for a single generation. Its memory comes from the FMemStack of the thread doing the
+ * generating, so it must not outlive the FMemMark that was set when it was filled.
+ */
+template <typename ElementType>
+using TDungeonScratchArray = TArray<ElementType, TMemStackAllocator<>>;
+
+/** The four sides of a tile, ordered the same way TryPlaceRoom picks a direction */
+enum class EDungeonDirection : uint8
+{
+	Top,	// +X
+	Right,	// +Y
+	Bottom,	// -X
+	Left	// -Y
+};
+
+/** What occupies a single cell of the tile grid */
+enum class EDungeonTileType : uint8
+{
+	Empty,
+	Room,
+	Corridor
+};
+
+struct FDungeonTile
+{
+	/** What is occupying the tile */
+	EDungeonTileType Type = EDungeonTileType::Empty;
+
+	/** Bit per EDungeonDirection, set when a corridor tile opens through a door on that side */
+	uint8 DoorMask = 0;
+
+	/** The index of the room covering the tile, INDEX_NONE if it isn't part of a room */
+	int32 RoomIndex = INDEX_NONE;
+
+	/** The index of the connected network of corridors the tile is part of, INDEX_NONE if it isn't a corridor */
+	int32 CorridorIndex = INDEX_NONE;
+};
+
+/** Two rooms that are close enough to each other to be connected by a corridor */
+struct FRoomAdjacency
+{
+	int32 RoomAIndex;
+	int32 RoomBIndex;
+
+	/** The number of empty tiles between the two rooms */
+	int32 Distance;
+
+	/** Returns a key that is the same whichever way round the two rooms are */
+	static FORCEINLINE uint64 MakeKey(int32 RoomA, int32 RoomB)
+	{
+		return (uint64(uint32(FMath::Min(RoomA, RoomB))) << 32) | uint32(FMath::Max(RoomA, RoomB));
+	}
+};
+
+/**
+ * Dense grid covering every room and corridor of the dungeon, one entry per tile.
+ * Cells are addressed in the same tile coordinates as URoom::Position.
+ */
+class DUNGEON_CPP_API FDungeonTileGrid
+{
+public:
+
+	/** Resizes the grid to cover Min (inclusive) to Max (exclusive) and clears every tile */
+	void Initialize(const FIntPoint& Min, const FIntPoint& Max);
+
+	/** Marks the tiles covered by a room */
+	void MarkRoom(const FIntPoint& Position, const FIntPoint& Size, int32 RoomIndex);
+
+	/**
+	 * Finds every pair of rooms that face each other across no more than MaxDistance empty tiles.
+	 * Grows all the rooms out at the same time and records where they meet, so each room is only paired with
+	 * the rooms around it rather than every other room. The caller's FMemMark owns OutNeighbours and the search's scratch data.
+	 */
+	void FindNeighbouringRooms(int32 MaxDistance, TDungeonScratchArray<FRoomAdjacency>& OutNeighbours) const;
+
+	/** Gives every connected network of corridor tiles its own CorridorIndex, returns the number of networks */
+	int32 LabelCorridors();
+
+	/**
+	 * Packs the type and doors of Count tiles from StartIndex into a byte each, room indexes aren't included as they come from the rooms.
+	 * Taking a range lets the grid be packed a block at a time into a fixed buffer.
+	 */
+	void PackTiles(int32 StartIndex, int32 Count, uint8* OutPackedTiles) const;
+
+	/** Restores the types and doors of every tile from PackTiles, the grid must already be the right size */
+	bool UnpackTiles(const TArray<uint8>& PackedTiles);
+
+	/** Returns the neighbouring cell on the Side of Cell */
+	static FIntPoint GetNeighbour(const FIntPoint& Cell, EDungeonDirection Side);
+
+	/** Returns the side facing the opposite way to Side */
+	static EDungeonDirection GetOpposite(EDungeonDirection Side);
+
+	/** Returns the wall pivot and rotation used to place a wall tile along the Side of Cell, facing into Cell */
+	static FIntPoint GetWallPivot(const FIntPoint& Cell, EDungeonDirection Side);
+	static FRotator GetWallRotation(EDungeonDirection Side);
+
+	FORCEINLINE bool IsInside(const FIntPoint& Cell) const
+	{
+		return Cell.X >= Origin.X && Cell.Y >= Origin.Y && Cell.X < Origin.X + Width && Cell.Y < Origin.Y + Height;
+	}
+
+	FORCEINLINE int32 ToIndex(const FIntPoint& Cell) const { return (Cell.X - Origin.X) * Height + (Cell.Y - Origin.Y); }
+
+	FORCEINLINE FIntPoint ToCell(int32 Index) const { return FIntPoint(Origin.X + Index / Height, Origin.Y + Index % Height); }
+
+	FORCEINLINE FDungeonTile& GetTile(const FIntPoint& Cell) { return Tiles[ToIndex(Cell)]; }
+	FORCEINLINE const FDungeonTile& GetTile(const FIntPoint& Cell) const { return Tiles[ToIndex(Cell)]; }
+
+	/** Returns the type of the tile at Cell, anything outside the grid is treated as empty */
+	FORCEINLINE EDungeonTileType GetTileType(const FIntPoint& Cell) const
+	{
+		return IsInside(Cell) ? Tiles[ToIndex(Cell)].Type : EDungeonTileType::Empty;
+	}
+
+	FORCEINLINE int32 Num() const { return Tiles.Num(); }
+
+	/** The tile coordinate of the first cell in the grid */
+	FIntPoint Origin = FIntPoint::ZeroValue;
+
+	/** The number of tiles along the X and Y */
+	int32 Width = 0;
+	int32 Height = 0;
+
+	/** The tiles stored X major so a row along the Y is contiguous */
+	TArray<FDungeonTile> Tiles;
+};
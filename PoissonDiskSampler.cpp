@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PoissonDiskSampler.h"
+#include "DungeonTileGrid.h"
+
+void FPoissonDiskSampler::Sample(const FBox2D& Area, float MinDistance, int32 MaxPoints, TArrayView<const FBox2D> BlockedAreas, FRandomStream& Stream, TArray<FVector2D>& OutPoints)
+{
+	if (MaxPoints <= 0 || MinDistance <= 0.f || Area.Min.X >= Area.Max.X || Area.Min.Y >= Area.Max.Y)
+	{
+		return;
+	}
+
+	FMemMark Mark(FMemStack::Get());
+
+	// Small enough that a cell can only ever hold one of the new points
+	float CellSize = MinDistance / FMath::Sqrt(2.f);
+	float MinDistanceSquared = FMath::Square(MinDistance);
+	FVector2D AreaSize = Area.GetSize();
+	int32 GridWidth = FMath::Max(FMath::CeilToInt(AreaSize.X / CellSize), 1);
+	int32 GridHeight = FMath::Max(FMath::CeilToInt(AreaSize.Y / CellSize), 1);
+
+	// Each cell is the head of a list of the points in it, the points already in OutPoints can share a cell
+	TDungeonScratchArray<int32> CellHeads;
+	CellHeads.Init(INDEX_NONE, GridWidth * GridHeight);
+
+	TDungeonScratchArray<int32> NextInCell;
+	NextInCell.Reserve(OutPoints.Num() + MaxPoints);
+
+	auto ToCell = [&](const FVector2D& Point)
+	{
+		// Points outside the area go in the nearest cell, they are never further from a candidate than their true cell
+		return FIntPoint(FMath::Clamp(FMath::FloorToInt((Point.X - Area.Min.X) / CellSize), 0, GridWidth - 1), FMath::Clamp(FMath::FloorToInt((Point.Y - Area.Min.Y) / CellSize), 0, GridHeight - 1));
+	};
+
+	auto AddToGrid = [&](int32 PointIndex)
+	{
+		FIntPoint Cell = ToCell(OutPoints[PointIndex]);
+		int32 CellIndex = Cell.Y * GridWidth + Cell.X;
+
+		NextInCell.Add(CellHeads[CellIndex]);
+		CellHeads[CellIndex] = PointIndex;
+	};
+
+	auto IsValidPoint = [&](const FVector2D& Point)
+	{
+		if (!Area.IsInside(Point))
+		{
+			return false;
+		}
+
+		for (const FBox2D& BlockedArea : BlockedAreas)
+		{
+			if (BlockedArea.IsInside(Point))
+			{
+				return false;
+			}
+		}
+
+		// Anything within MinDistance is at most two cells away
+		FIntPoint Cell = ToCell(Point);
+
+		for (int32 y = FMath::Max(Cell.Y - 2, 0); y <= FMath::Min(Cell.Y + 2, GridHeight - 1); y++)
+		{
+			for (int32 x = FMath::Max(Cell.X - 2, 0); x <= FMath::Min(Cell.X + 2, GridWidth - 1); x++)
+			{
+				for (int32 PointIndex = CellHeads[y * GridWidth + x]; PointIndex != INDEX_NONE; PointIndex = NextInCell[PointIndex])
+				{
+					if (FVector2D::DistSquared(Point, OutPoints[PointIndex]) < MinDistanceSquared)
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		return true;
+	};
+
+	for (int32 PointIndex = 0; PointIndex < OutPoints.Num(); PointIndex++)
+	{
+		AddToGrid(PointIndex);
+	}
+
+	int32 FirstNewPoint = OutPoints.Num();
+	TDungeonScratchArray<int32> ActivePoints;
+
+	auto AddPoint = [&](const FVector2D& Point)
+	{
+		int32 PointIndex = OutPoints.Add(Point);
+		AddToGrid(PointIndex);
+		ActivePoints.Add(PointIndex);
+	};
+
+	// Start from a random point, trying a few in case the first lands somewhere blocked
+	for (int32 Attempt = 0; Attempt < NumCandidatesPerPoint; Attempt++)
+	{
+		FVector2D Point(FMath::Lerp(Area.Min.X, Area.Max.X, Stream.FRand()), FMath::Lerp(Area.Min.Y, Area.Max.Y, Stream.FRand()));
+
+		if (IsValidPoint(Point))
+		{
+			AddPoint(Point);
+			break;
+		}
+	}
+
+	while (ActivePoints.Num() > 0 && OutPoints.Num() - FirstNewPoint < MaxPoints)
+	{
+		int32 ActiveIndex = Stream.RandHelper(ActivePoints.Num());
+		FVector2D Origin = OutPoints[ActivePoints[ActiveIndex]];
+		bool bAddedPoint = false;
+
+		// Try points in the ring between MinDistance and twice MinDistance around the active point
+		for (int32 Attempt = 0; Attempt < NumCandidatesPerPoint; Attempt++)
+		{
+			float Angle = Stream.FRand() * 2.f * PI;
+			float Distance = MinDistance * (1.f + Stream.FRand());
+			FVector2D Candidate = Origin + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Distance;
+
+			if (IsValidPoint(Candidate))
+			{
+				AddPoint(Candidate);
+				bAddedPoint = true;
+				break;
+			}
+		}
+
+		if (!bAddedPoint)
+		{
+			ActivePoints.RemoveAtSwap(ActiveIndex, 1, false);
+		}
+	}
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Blue noise sampling using Bridson's algorithm. New points are grown out from the ones already placed, and a background
+ * grid with a cell per MinDistance / sqrt(2) means each candidate only has to check the few cells around it.
+ */
+class DUNGEON_CPP_API FPoissonDiskSampler
+{
+public:
+
+	/** The number of candidates tried around a point before it stops being grown from */
+	static constexpr int32 NumCandidatesPerPoint = 30;
+
+	/**
+	 * Adds up to MaxPoints points inside Area to OutPoints, no closer than MinDistance to each other or to the points already in OutPoints.
+	 * Candidates inside any of the BlockedAreas are rejected. Only the Stream is used so the same seed always gives the same points.
+	 */
+	static void Sample(const FBox2D& Area, float MinDistance, int32 MaxPoints, TArrayView<const FBox2D> BlockedAreas, FRandomStream& Stream, TArray<FVector2D>& OutPoints);
+};
@@ -1,19 +1,24 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-
-#include "Room.h"
-
-URoom::URoom()
-{
-
-}
-
-FVector URoom::GetCenterOfRoom()
-{
-	return Position + (Size / 2);
-}
-
-FVector URoom::GetRoomMax()
-{
-	return Position + Size;
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Room.h"
+
+URoom::URoom()
+{
+
+}
+
+FVector URoom::GetCenterOfRoom()
+{
+	return FVector(Position.X + Size.X / 2.f, Position.Y + Size.Y / 2.f, 0.f);
+}
+
+FIntPoint URoom::GetRoomMax()
+{
+	return Position + Size;
+}
+
+FIntRect URoom::GetRoomRect()
+{
+	return FIntRect(Position, Position + Size);
 }
\ No newline at end of file
@@ -1,54 +1,60 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "UObject/NoExportTypes.h"
-#include "Room.generated.h"
-
-/**
- * 
- */
-
-UCLASS()
-class DUNGEON_CPP_API URoom : public UObject
-{
-	GENERATED_BODY()
-
-public:
-
-	URoom();
-
-	/** The rooms position in World Space */
-	FVector Position;
-
-	/** The rooms size */
-	FVector Size;
-
-	/** Whether or not the can be placed in the world */
-	bool bCanBePlaced;
-
-	/** A unique identifier for the room */
-	int32 Index;
-
-	/** The location of the doors on this room */
-	TArray<FVector> DoorLocations;
-
-	/** The number of tiles high the room is */
-	int32 WallHeight;
-
-	/** The name of the row in the Data Table being used for this room */
-	FName RoomTypeRowName;
-
-public:
-
-	/** Returns the centre point of the room */
-	FVector GetCenterOfRoom();
-	
-	/** Returns the extent of the room */
-	FVector GetRoomMax();
-
-	FORCEINLINE void SetRoomPosition(FVector Pos) { Position = Pos; }
-
-	FORCEINLINE void SetWallHeight(int32 Height) { WallHeight = Height; }
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Room.generated.h"
+
+/**
+ * 
+ */
+
+UCLASS()
+class DUNGEON_CPP_API URoom : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	URoom();
+
+	/** The tile of the room's lowest corner, multiplied by the TileSize only when the tiles are spawned */
+	FIntPoint Position;
+
+	/** The number of tiles the room covers along the X and Y */
+	FIntPoint Size;
+
+	/** Whether or not the can be placed in the world */
+	bool bCanBePlaced;
+
+	/** A unique identifier for the room */
+	int32 Index;
+
+	/** The wall pivots of the doors on this room, in tiles */
+	TArray<FIntPoint> DoorLocations;
+
+	/** The number of tiles high the room is */
+	int32 WallHeight;
+
+	/** The name of the row in the Data Table being used for this room */
+	FName RoomTypeRowName;
+
+	/** Whether tiles were spawned for the room, rooms stamped with a template or left empty have none */
+	bool bHasTiles;
+
+public:
+
+	/** Returns the centre point of the room */
+	FVector GetCenterOfRoom();
+	
+	/** Returns the extent of the room */
+	FIntPoint GetRoomMax();
+
+	/** Returns the tiles covered by the room, Max is exclusive */
+	FIntRect GetRoomRect();
+
+	FORCEINLINE void SetRoomPosition(FIntPoint Pos) { Position = Pos; }
+
+	FORCEINLINE void SetWallHeight(int32 Height) { WallHeight = Height; }
+};
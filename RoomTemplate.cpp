@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "RoomTemplate.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "GameFramework/Actor.h"
+
+bool URoomTemplate::CanBeUsedFor(const FIntPoint& Size, TArrayView<const FIntPoint> DoorLocations) const
+{
+	if (Size != Footprint)
+	{
+		return false;
+	}
+
+	for (const FIntPoint& DoorLocation : DoorLocations)
+	{
+		if (!DoorSockets.Contains(DoorLocation))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#if WITH_EDITOR
+void URoomTemplate::CaptureActor(AActor* SourceActor)
+{
+	if (!SourceActor)
+	{
+		return;
+	}
+
+	Modify();
+	Meshes.Reset();
+
+	FTransform ActorTransform = SourceActor->GetActorTransform();
+
+	auto AddInstance = [this](UStaticMesh* Mesh, const FTransform& Transform)
+	{
+		FRoomTemplateMesh* TemplateMesh = Meshes.FindByPredicate([Mesh](const FRoomTemplateMesh& Other) { return Other.Mesh == Mesh; });
+
+		if (!TemplateMesh)
+		{
+			TemplateMesh = &Meshes.AddDefaulted_GetRef();
+			TemplateMesh->Mesh = Mesh;
+		}
+
+		TemplateMesh->Transforms.Add(Transform);
+	};
+
+	TInlineComponentArray<UStaticMeshComponent*> MeshComponents(SourceActor);
+
+	for (UStaticMeshComponent* MeshComponent : MeshComponents)
+	{
+		UStaticMesh* Mesh = MeshComponent->GetStaticMesh();
+
+		if (!Mesh)
+		{
+			continue;
+		}
+
+		if (UInstancedStaticMeshComponent* InstancedComponent = Cast<UInstancedStaticMeshComponent>(MeshComponent))
+		{
+			for (int32 InstanceIndex = 0; InstanceIndex < InstancedComponent->GetInstanceCount(); InstanceIndex++)
+			{
+				FTransform InstanceTransform;
+				InstancedComponent->GetInstanceTransform(InstanceIndex, InstanceTransform, true);
+				AddInstance(Mesh, InstanceTransform.GetRelativeTransform(ActorTransform));
+			}
+		}
+		else
+		{
+			AddInstance(Mesh, MeshComponent->GetComponentTransform().GetRelativeTransform(ActorTransform));
+		}
+	}
+
+	MarkPackageDirty();
+}
+#endif
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "RoomTemplate.generated.h"
+
+USTRUCT(BlueprintType)
+struct FRoomTemplateMesh
+{
+	GENERATED_BODY()
+
+	/** The mesh placed by the template */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	class UStaticMesh* Mesh;
+
+	/** Where each instance of the mesh goes, relative to the lowest corner of the room */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FTransform> Transforms;
+};
+
+/**
+ * A hand built room such as a boss room or shop. Its meshes are stored as a list of instances per mesh so the whole room
+ * is added to the dungeon in one go per mesh, rather than picking a random tile for every cell.
+ */
+UCLASS(BlueprintType)
+class DUNGEON_CPP_API URoomTemplate : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	/** The number of tiles the template covers along the X and Y, it's only used for rooms of exactly this size */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Room Template")
+	FIntPoint Footprint;
+
+	/** The wall pivots the template has an opening at, relative to the lowest corner. Every door of a room must be on a socket to use the template */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Room Template")
+	TArray<FIntPoint> DoorSockets;
+
+	/** The instances of each mesh */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Room Template")
+	TArray<FRoomTemplateMesh> Meshes;
+
+	/** Returns true if the template fits a room of Size with doors at the DoorLocations, given relative to the room's lowest corner */
+	bool CanBeUsedFor(const FIntPoint& Size, TArrayView<const FIntPoint> DoorLocations) const;
+
+#if WITH_EDITOR
+	/** Replaces the Meshes with every static mesh and instance on the SourceActor, relative to the actor */
+	UFUNCTION(BlueprintCallable, Category = "Room Template")
+	void CaptureActor(AActor* SourceActor);
+#endif
+};